@@ -0,0 +1,200 @@
+# Copyright 2026 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Generate type-specialised CDR serializers for the messages of a package.
+
+Invoked by rmw_cyclonedds_cpp_generate_codecs(); see
+include/rmw_cyclonedds_cpp/generated_codec.hpp for what the generated code provides.
+"""
+
+import argparse
+import os
+import pathlib
+import re
+import sys
+
+from rosidl_parser.definition import AbstractSequence
+from rosidl_parser.definition import Array
+from rosidl_parser.definition import IdlLocator
+from rosidl_parser.definition import Message
+from rosidl_parser.definition import NamespacedType
+from rosidl_parser.parser import parse_idl_file
+
+
+def to_snake_case(name):
+    # same as rosidl_cmake's convert_camel_case_to_lower_case_underscore, used for header names
+    name = re.sub('([A-Z])([A-Z][a-z])', r'\1_\2', name)
+    name = re.sub('([a-z0-9])([A-Z])', r'\1_\2', name)
+    return name.lower()
+
+
+def type_key(namespaced_type):
+    return tuple(namespaced_type.namespaces) + (namespaced_type.name,)
+
+
+def cpp_type(key):
+    return '::'.join(key)
+
+
+def find_message(key, include_paths):
+    relative_path = pathlib.Path(*key[1:-1]) / (key[-1] + '.idl')
+    search_paths = list(include_paths)
+    search_paths += [
+        os.path.join(prefix, 'share')
+        for prefix in os.environ.get('AMENT_PREFIX_PATH', '').split(os.pathsep) if prefix]
+    for search_path in search_paths:
+        base_path = pathlib.Path(search_path) / key[0]
+        if (base_path / relative_path).is_file():
+            idl_file = parse_idl_file(IdlLocator(base_path, relative_path))
+            for message in idl_file.content.get_elements_of_type(Message):
+                if type_key(message.structure.namespaced_type) == key:
+                    return message
+    sys.exit('cannot find the definition of %s' % cpp_type(key))
+
+
+def ordered_messages(local_messages, include_paths):
+    """Return the keys of the local messages and those they contain, dependencies first."""
+    messages = dict(local_messages)
+    ordered = []
+    done = set()
+
+    def visit(key):
+        if key in done:
+            return
+        done.add(key)
+        if key not in messages:
+            messages[key] = find_message(key, include_paths)
+        for member in messages[key].structure.members:
+            member_type = member.type
+            if isinstance(member_type, (Array, AbstractSequence)):
+                member_type = member_type.value_type
+            if isinstance(member_type, NamespacedType):
+                visit(type_key(member_type))
+        ordered.append(key)
+
+    for key in local_messages:
+        visit(key)
+    return ordered, messages
+
+
+def member_functions(member):
+    if isinstance(member.type, Array):
+        return 'write_array', 'read_array'
+    if isinstance(member.type, AbstractSequence):
+        return 'write_sequence', 'read_sequence'
+    return 'write', 'read'
+
+
+def generate_codec(key, message):
+    members = message.structure.members
+    lines = [
+        'template<>',
+        'struct Codec<%s>' % cpp_type(key),
+        '{',
+        '  template<typename Stream>',
+        '  static void write(Stream & s, const %s & message)' % cpp_type(key),
+        '  {',
+    ]
+    for member in members:
+        lines.append('    codec::%s(s, message.%s);' % (member_functions(member)[0], member.name))
+    lines += [
+        '  }',
+        '',
+        '  static bool read(ReadStream & r, %s & message)' % cpp_type(key),
+        '  {',
+        '    return',
+    ]
+    reads = [
+        'codec::%s(r, message.%s)' % (member_functions(member)[1], member.name)
+        for member in members]
+    lines.append('      ' + ' &&\n      '.join(reads) + ';')
+    lines += [
+        '  }',
+        '};',
+        '',
+    ]
+    return lines
+
+
+def generate(package_name, idl_tuples, include_paths):
+    local_messages = {}
+    for idl_tuple in idl_tuples:
+        base_path, relative_path = idl_tuple.rsplit(':', 1)
+        idl_file = parse_idl_file(IdlLocator(pathlib.Path(base_path), pathlib.Path(relative_path)))
+        for message in idl_file.content.get_elements_of_type(Message):
+            local_messages[type_key(message.structure.namespaced_type)] = message
+    ordered, messages = ordered_messages(local_messages, include_paths)
+
+    lines = [
+        '// generated from rmw_cyclonedds_cpp/cmake/generate_codecs.py',
+        '// for the messages of package %s' % package_name,
+        '// generated code does not contain a copyright notice',
+        '',
+        '#include "rmw_cyclonedds_cpp/generated_codec.hpp"',
+        '',
+    ]
+    lines += sorted(
+        '#include "%s/%s.hpp"' % ('/'.join(key[:-1]), to_snake_case(key[-1])) for key in ordered)
+    lines += [
+        '',
+        'namespace rmw_cyclonedds_cpp',
+        '{',
+        'namespace codec',
+        '{',
+        '',
+    ]
+    for key in ordered:
+        lines += generate_codec(key, messages[key])
+    lines += [
+        '}  // namespace codec',
+        '}  // namespace rmw_cyclonedds_cpp',
+        '',
+    ]
+    for key in ordered:
+        if key not in local_messages:
+            continue
+        lines += [
+            'extern "C" RMW_CYCLONEDDS_CPP_GENERATED_CODEC_EXPORT',
+            'const rmw_cyclonedds_cpp::GeneratedCodec *',
+            'rmw_cyclonedds_cpp__get_generated_codec__%s()' % '__'.join(key),
+            '{',
+            '  return rmw_cyclonedds_cpp::codec::make_generated_codec<%s>();' % cpp_type(key),
+            '}',
+            '',
+        ]
+    return '\n'.join(lines)
+
+
+def main(argv=sys.argv[1:]):
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--package-name', required=True)
+    parser.add_argument('--output-file', required=True)
+    parser.add_argument(
+        '--include-path', action='append', default=[],
+        help='share directory to search for the .idl files of other packages')
+    parser.add_argument(
+        'idl_tuples', nargs='+', metavar='BASE_PATH:RELATIVE_PATH',
+        help='the .idl files of the package, as passed to the rosidl generators')
+    args = parser.parse_args(argv)
+
+    content = generate(args.package_name, args.idl_tuples, args.include_path)
+    output_file = pathlib.Path(args.output_file)
+    output_file.parent.mkdir(parents=True, exist_ok=True)
+    output_file.write_text(content)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,123 @@
+# Copyright 2026 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Generate type-specialised CDR serializers for the messages of a package.
+#
+# Builds and installs the library ${PROJECT_NAME}__rmw_cyclonedds_cpp, which
+# rmw_cyclonedds_cpp loads when one of these messages is first used with the
+# C++ typesupport, and then uses instead of the introspection typesupport to
+# serialize and deserialize it.  Services and actions are ignored.
+#
+# Must be called after rosidl_generate_interfaces(), with the same arguments:
+#
+#   rosidl_generate_interfaces(${PROJECT_NAME} "msg/Foo.msg" DEPENDENCIES std_msgs)
+#   rmw_cyclonedds_cpp_generate_codecs(${PROJECT_NAME} "msg/Foo.msg" DEPENDENCIES std_msgs)
+#
+# :param target: the target name passed to rosidl_generate_interfaces()
+# :type target: string
+# :param ARGN: the interface files passed to rosidl_generate_interfaces(),
+#   followed by the keyword DEPENDENCIES and the packages providing the
+#   messages these contain
+# :type ARGN: list of strings
+#
+# @public
+#
+function(rmw_cyclonedds_cpp_generate_codecs target)
+  cmake_parse_arguments(_ARG "" "" "DEPENDENCIES" ${ARGN})
+
+  set(_idl_tuples "")
+  set(_idl_files "")
+  foreach(_interface ${_ARG_UNPARSED_ARGUMENTS})
+    get_filename_component(_dir "${_interface}" DIRECTORY)
+    get_filename_component(_dir "${_dir}" NAME)
+    get_filename_component(_name "${_interface}" NAME_WE)
+    get_filename_component(_ext "${_interface}" EXT)
+    if(NOT _dir STREQUAL "msg")
+      continue()
+    endif()
+    if(_ext STREQUAL ".idl")
+      set(_base "${CMAKE_CURRENT_SOURCE_DIR}")
+      set(_relative "${_interface}")
+    else()
+      # converted to .idl by rosidl_generate_interfaces()
+      set(_base "${CMAKE_CURRENT_BINARY_DIR}/rosidl_adapter/${PROJECT_NAME}")
+      set(_relative "msg/${_name}.idl")
+    endif()
+    list(APPEND _idl_tuples "${_base}:${_relative}")
+    list(APPEND _idl_files "${_base}/${_relative}")
+  endforeach()
+  if(NOT _idl_tuples)
+    message(FATAL_ERROR "rmw_cyclonedds_cpp_generate_codecs() called without any messages")
+  endif()
+
+  set(_include_args "")
+  foreach(_dep ${_ARG_DEPENDENCIES})
+    if(NOT ${_dep}_DIR)
+      message(FATAL_ERROR
+        "rmw_cyclonedds_cpp_generate_codecs() dependency '${_dep}' has not been found")
+    endif()
+    # ${_dep}_DIR is <prefix>/share/${_dep}/cmake
+    get_filename_component(_share_dir "${${_dep}_DIR}/../.." ABSOLUTE)
+    list(APPEND _include_args "--include-path" "${_share_dir}")
+  endforeach()
+
+  if(PYTHON_EXECUTABLE)
+    set(_python "${PYTHON_EXECUTABLE}")
+  else()
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+    set(_python "${Python3_EXECUTABLE}")
+  endif()
+
+  set(_generator "${rmw_cyclonedds_cpp_DIR}/generate_codecs.py")
+  set(_output_file "${CMAKE_CURRENT_BINARY_DIR}/rmw_cyclonedds_cpp/${PROJECT_NAME}__codecs.cpp")
+  add_custom_command(
+    OUTPUT "${_output_file}"
+    COMMAND "${_python}" "${_generator}"
+      --package-name "${PROJECT_NAME}"
+      --output-file "${_output_file}"
+      ${_include_args}
+      ${_idl_tuples}
+    DEPENDS "${_generator}" ${_idl_files}
+    COMMENT "Generating rmw_cyclonedds_cpp codecs for ${PROJECT_NAME}"
+    VERBATIM)
+
+  # the name rmw_cyclonedds_cpp looks for, so it can't be derived from ${target}
+  set(_library "${PROJECT_NAME}__rmw_cyclonedds_cpp")
+  add_library(${_library} SHARED "${_output_file}")
+  set_target_properties(${_library} PROPERTIES
+    CXX_VISIBILITY_PRESET hidden
+    VISIBILITY_INLINES_HIDDEN ON)
+  if(NOT CMAKE_CXX_STANDARD)
+    set_target_properties(${_library} PROPERTIES CXX_STANDARD 14)
+  endif()
+  target_include_directories(${_library} PRIVATE ${rmw_cyclonedds_cpp_INCLUDE_DIRS})
+  if(TARGET ${target}__rosidl_generator_cpp)
+    target_link_libraries(${_library} ${target}__rosidl_generator_cpp)
+  else()
+    target_include_directories(${_library} PRIVATE
+      "${CMAKE_CURRENT_BINARY_DIR}/rosidl_generator_cpp")
+    add_dependencies(${_library} ${target}__cpp)
+    if(_ARG_DEPENDENCIES)
+      ament_target_dependencies(${_library} ${_ARG_DEPENDENCIES})
+    endif()
+  endif()
+
+  install(
+    TARGETS ${_library}
+    ARCHIVE DESTINATION lib
+    LIBRARY DESTINATION lib
+    RUNTIME DESTINATION bin
+  )
+endfunction()
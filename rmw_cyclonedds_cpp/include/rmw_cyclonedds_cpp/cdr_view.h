@@ -0,0 +1,90 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RMW_CYCLONEDDS_CPP__CDR_VIEW_H_
+#define RMW_CYCLONEDDS_CPP__CDR_VIEW_H_
+
+/* Read-only access to the fields of a message in its serialized form.
+
+   Taking a message as a CDR view avoids deserializing it, which is worth it when only a few
+   fields are of interest, e.g., the header stamp for throttling:
+
+     rmw_cyclonedds_cpp_cdr_view_t * view;
+     bool taken;
+     rmw_cyclonedds_cpp_take_cdr_view(subscription, &view, &taken, NULL);
+     if (taken) {
+       int32_t sec;
+       rmw_cyclonedds_cpp_cdr_view_get_primitive(view, "header.stamp.sec", &sec, sizeof(sec));
+       rmw_cyclonedds_cpp_return_cdr_view(view);
+     }
+
+   Fields are named by a path of member names separated by periods, with an index in
+   brackets for an element of an array or sequence, e.g., "poses[2].position.x".  Locating a
+   field only walks the data preceding it that hasn't been walked before.
+
+   A view must be returned before the subscription it was taken from is destroyed, and a view
+   must not be used by several threads at the same time. */
+
+#include <stddef.h>
+
+#include "rmw/rmw.h"
+#include "rmw/visibility_control.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct rmw_cyclonedds_cpp_cdr_view_s rmw_cyclonedds_cpp_cdr_view_t;
+
+/* Take a message like rmw_take_with_info, but return a view of the serialized message
+   rather than deserializing it.  message_info may be a null pointer. */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_take_cdr_view(
+  const rmw_subscription_t * subscription, rmw_cyclonedds_cpp_cdr_view_t ** view,
+  bool * taken, rmw_message_info_t * message_info);
+
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_return_cdr_view(rmw_cyclonedds_cpp_cdr_view_t * view);
+
+/* Copy the value of a field of a primitive type into `value`, which has the field's C type of
+   `size` bytes */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_primitive(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, void * value, size_t size);
+
+/* Return the contents of a string field, which remain valid until the view is returned */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_string(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, const char ** data,
+  size_t * length);
+
+/* Return the number of elements of an array, sequence, string or wstring field */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_size(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, size_t * size);
+
+/* Return the serialized elements of an array or sequence of a primitive type, which remain
+   valid until the view is returned.  They aren't necessarily aligned, and this fails with
+   RMW_RET_UNSUPPORTED if the byte order of the data differs from the native one for elements
+   of more than one byte. */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_data(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, const void ** data,
+  size_t * size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RMW_CYCLONEDDS_CPP__CDR_VIEW_H_
@@ -0,0 +1,490 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RMW_CYCLONEDDS_CPP__GENERATED_CODEC_HPP_
+#define RMW_CYCLONEDDS_CPP__GENERATED_CODEC_HPP_
+
+/* Support code for the type-specialised serializers generated by the CMake function
+   rmw_cyclonedds_cpp_generate_codecs().
+
+   For every message type pkg::msg::Name, the generated library specialises
+   rmw_cyclonedds_cpp::codec::Codec<pkg::msg::Name> and exports
+
+     extern "C" const rmw_cyclonedds_cpp::GeneratedCodec *
+     rmw_cyclonedds_cpp__get_generated_codec__pkg__msg__Name();
+
+   which rmw_cyclonedds_cpp looks up in lib<pkg>__rmw_cyclonedds_cpp when the type is first
+   used with the C++ introspection typesupport.  The encoding is the same XCDR1 produced by the
+   introspection-based serializer, so both ends of a connection are free to use either. */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined _WIN32 || defined __CYGWIN__
+#define RMW_CYCLONEDDS_CPP_GENERATED_CODEC_EXPORT __declspec(dllexport)
+#else
+#define RMW_CYCLONEDDS_CPP_GENERATED_CODEC_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* bumped whenever GeneratedCodec or the encoding changes incompatibly */
+#define RMW_CYCLONEDDS_CPP_GENERATED_CODEC_VERSION 1u
+
+namespace rmw_cyclonedds_cpp
+{
+
+struct GeneratedCodec
+{
+  /* RMW_CYCLONEDDS_CPP_GENERATED_CODEC_VERSION the codec was generated with */
+  uint32_t version;
+  /* sizeof the C++ message struct, checked against the introspection typesupport */
+  size_t sizeof_message;
+  /* size of the serialized message, including the 4-byte encapsulation header */
+  size_t (* get_serialized_size)(const void * message);
+  /* write the encapsulation header and the message, dest must hold get_serialized_size bytes */
+  void (* serialize)(const void * message, void * dest);
+  /* decode a serialized message, encapsulation header included; false if it is malformed */
+  bool (* deserialize)(const void * src, size_t size, void * message);
+};
+
+namespace codec
+{
+
+/// Specialised by the generated code for each message type with a static
+///   template<typename Stream> void write(Stream &, const Message &)
+///   bool read(ReadStream &, Message &)
+template<typename Message>
+struct Codec;
+
+inline bool native_is_little_endian()
+{
+  const uint16_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+template<typename T>
+struct is_primitive : std::integral_constant<bool, std::is_arithmetic<T>::value> {};
+
+/* long double is always 16 bytes in CDR, whatever the platform makes of it */
+template<typename T>
+struct cdr_size : std::integral_constant<size_t, sizeof(T)> {};
+template<>
+struct cdr_size<long double> : std::integral_constant<size_t, 16> {};
+
+template<typename T>
+struct cdr_align
+  : std::integral_constant<size_t, (cdr_size<T>::value < 8) ? cdr_size<T>::value : 8> {};
+
+/* true if consecutive elements can be copied to and from the CDR stream in one go */
+template<typename T>
+struct is_memcpy_element
+  : std::integral_constant<bool, is_primitive<T>::value && !std::is_same<T, bool>::value &&
+    sizeof(T) == cdr_size<T>::value> {};
+
+/* Offsets are relative to the first byte following the encapsulation header, like the
+   alignment in CDR itself. */
+class SizeStream
+{
+public:
+  void align(size_t n) {m_offset += (n - m_offset % n) % n;}
+  void put(const void *, size_t n) {m_offset += n;}
+  size_t offset() const {return m_offset;}
+
+private:
+  size_t m_offset {0};
+};
+
+class WriteStream
+{
+public:
+  explicit WriteStream(void * origin)
+  : m_origin(static_cast<unsigned char *>(origin)) {}
+  void align(size_t n)
+  {
+    size_t pad = (n - m_offset % n) % n;
+    std::memset(m_origin + m_offset, 0, pad);
+    m_offset += pad;
+  }
+  void put(const void * data, size_t n)
+  {
+    if (n > 0) {
+      std::memcpy(m_origin + m_offset, data, n);
+      m_offset += n;
+    }
+  }
+  size_t offset() const {return m_offset;}
+
+private:
+  unsigned char * m_origin;
+  size_t m_offset {0};
+};
+
+class ReadStream
+{
+public:
+  ReadStream(const void * data, size_t size)
+  : m_data(static_cast<const unsigned char *>(data) + 4),
+    m_size(size >= 4 ? size - 4 : 0),
+    m_valid(size >= 4),
+    m_swap_bytes(m_valid && ((m_data[-3] == 1) != native_is_little_endian()))
+  {
+  }
+  bool valid() const {return m_valid;}
+  bool swap_bytes() const {return m_swap_bytes;}
+  size_t remaining() const {return m_size - m_offset;}
+  bool align(size_t n)
+  {
+    size_t pad = (n - m_offset % n) % n;
+    if (pad > remaining()) {
+      return false;
+    }
+    m_offset += pad;
+    return true;
+  }
+  /* pointer to the next n bytes, or nullptr if there aren't that many */
+  const unsigned char * get(size_t n)
+  {
+    if (n > remaining()) {
+      return nullptr;
+    }
+    const unsigned char * p = m_data + m_offset;
+    m_offset += n;
+    return p;
+  }
+
+private:
+  const unsigned char * m_data;
+  size_t m_size;
+  size_t m_offset {0};
+  bool m_valid;
+  bool m_swap_bytes;
+};
+
+inline void swap_bytes_in_place(void * data, size_t n)
+{
+  auto bytes = static_cast<unsigned char *>(data);
+  std::reverse(bytes, bytes + n);
+}
+
+/* Writing.  All overloads are declared before the templates that use them, as the element
+   types are not in this namespace and so argument-dependent lookup won't find them. */
+
+template<typename Stream, typename T>
+void write_primitive(Stream & s, const T & value)
+{
+  s.align(cdr_align<T>::value);
+  if (sizeof(T) >= cdr_size<T>::value) {
+    s.put(&value, cdr_size<T>::value);
+  } else {
+    unsigned char buf[cdr_size<T>::value] = {};
+    std::memcpy(buf, &value, sizeof(T));
+    s.put(buf, sizeof(buf));
+  }
+}
+
+template<typename Stream, typename T>
+void write_value(Stream & s, const T & value, std::true_type /* is_primitive */)
+{
+  write_primitive(s, value);
+}
+
+template<typename Stream, typename T>
+void write_value(Stream & s, const T & value, std::false_type /* is_primitive */)
+{
+  Codec<T>::write(s, value);
+}
+
+template<typename Stream, typename T>
+void write(Stream & s, const T & value)
+{
+  write_value(s, value, is_primitive<T>());
+}
+
+template<typename Stream>
+void write_u32(Stream & s, size_t value)
+{
+  write_primitive(s, static_cast<uint32_t>(value));
+}
+
+template<typename Stream>
+void write(Stream & s, const std::string & value)
+{
+  write_u32(s, value.size() + 1);
+  s.put(value.c_str(), value.size() + 1);
+}
+
+/* wide strings go out as wchar_t, for compatibility with the introspection serializer */
+template<typename Stream>
+void write(Stream & s, const std::u16string & value)
+{
+  write_u32(s, value.size());
+  for (char16_t c : value) {
+    wchar_t w = static_cast<wchar_t>(c);
+    s.put(&w, sizeof(w));
+  }
+}
+
+template<typename Stream, typename T>
+void write_elements(Stream & s, const T * elements, size_t n, std::true_type /* memcpy */)
+{
+  if (n > 0) {
+    s.align(cdr_align<T>::value);
+    s.put(elements, n * sizeof(T));
+  }
+}
+
+template<typename Stream, typename Range>
+void write_elements(Stream & s, const Range & range, std::false_type /* memcpy */)
+{
+  for (const auto & element : range) {
+    write(s, static_cast<const typename Range::value_type &>(element));
+  }
+}
+
+template<typename Stream, typename Range>
+void write_elements(Stream & s, const Range & range, std::true_type /* memcpy */)
+{
+  write_elements(s, range.data(), range.size(), std::true_type());
+}
+
+/* fixed-size arrays: the elements without a length */
+template<typename Stream, typename Array>
+void write_array(Stream & s, const Array & array)
+{
+  write_elements(s, array, is_memcpy_element<typename Array::value_type>());
+}
+
+/* bounded and unbounded sequences: the length followed by the elements */
+template<typename Stream, typename Sequence>
+void write_sequence(Stream & s, const Sequence & sequence)
+{
+  write_u32(s, sequence.size());
+  write_elements(s, sequence, is_memcpy_element<typename Sequence::value_type>());
+}
+
+/* Reading */
+
+template<typename T>
+bool read_primitive(ReadStream & r, T & value)
+{
+  const unsigned char * p;
+  if (!r.align(cdr_align<T>::value) || !(p = r.get(cdr_size<T>::value))) {
+    return false;
+  }
+  unsigned char buf[cdr_size<T>::value];
+  std::memcpy(buf, p, sizeof(buf));
+  if (r.swap_bytes()) {
+    swap_bytes_in_place(buf, sizeof(buf));
+  }
+  std::memcpy(&value, buf, std::min(sizeof(T), sizeof(buf)));
+  return true;
+}
+
+inline bool read_primitive(ReadStream & r, bool & value)
+{
+  const unsigned char * p = r.get(1);
+  if (!p) {
+    return false;
+  }
+  value = (*p != 0);
+  return true;
+}
+
+template<typename T>
+bool read_value(ReadStream & r, T & value, std::true_type /* is_primitive */)
+{
+  return read_primitive(r, value);
+}
+
+template<typename T>
+bool read_value(ReadStream & r, T & value, std::false_type /* is_primitive */)
+{
+  return Codec<T>::read(r, value);
+}
+
+template<typename T>
+bool read(ReadStream & r, T & value)
+{
+  return read_value(r, value, is_primitive<T>());
+}
+
+inline bool read_u32(ReadStream & r, uint32_t & value)
+{
+  return read_primitive(r, value);
+}
+
+inline bool read(ReadStream & r, std::string & value)
+{
+  uint32_t size;
+  const unsigned char * p;
+  if (!read_u32(r, size) || !(p = r.get(size))) {
+    return false;
+  }
+  if (size == 0) {
+    value.clear();
+  } else if (p[size - 1] != '\0') {
+    return false;
+  } else {
+    value.assign(reinterpret_cast<const char *>(p), size - 1);
+  }
+  return true;
+}
+
+inline bool read(ReadStream & r, std::u16string & value)
+{
+  uint32_t size;
+  if (!read_u32(r, size) || size > r.remaining() / sizeof(wchar_t)) {
+    return false;
+  }
+  const unsigned char * p = r.get(size * sizeof(wchar_t));
+  value.resize(size);
+  for (uint32_t i = 0; i < size; i++) {
+    wchar_t w;
+    std::memcpy(&w, p + i * sizeof(wchar_t), sizeof(w));
+    if (r.swap_bytes()) {
+      swap_bytes_in_place(&w, sizeof(w));
+    }
+    value[i] = static_cast<char16_t>(w);
+  }
+  return true;
+}
+
+template<typename T>
+bool read_elements(ReadStream & r, T * elements, size_t n, std::true_type /* memcpy */)
+{
+  if (n == 0) {
+    return true;
+  }
+  const unsigned char * p;
+  if (!r.align(cdr_align<T>::value) || n > r.remaining() / sizeof(T) ||
+    !(p = r.get(n * sizeof(T))))
+  {
+    return false;
+  }
+  std::memcpy(static_cast<void *>(elements), p, n * sizeof(T));
+  if (r.swap_bytes() && sizeof(T) > 1) {
+    for (size_t i = 0; i < n; i++) {
+      swap_bytes_in_place(&elements[i], sizeof(T));
+    }
+  }
+  return true;
+}
+
+template<typename Range>
+bool read_elements(ReadStream & r, Range & range, std::true_type /* memcpy */)
+{
+  return read_elements(r, range.data(), range.size(), std::true_type());
+}
+
+template<typename Range>
+bool read_nontrivial_elements(ReadStream & r, Range & range, std::false_type /* is bool */)
+{
+  for (auto & element : range) {
+    if (!read(r, element)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* std::vector<bool> hands out proxies instead of references */
+template<typename Range>
+bool read_nontrivial_elements(ReadStream & r, Range & range, std::true_type /* is bool */)
+{
+  for (size_t i = 0; i < range.size(); i++) {
+    bool element;
+    if (!read_primitive(r, element)) {
+      return false;
+    }
+    range[i] = element;
+  }
+  return true;
+}
+
+template<typename Range>
+bool read_elements(ReadStream & r, Range & range, std::false_type /* memcpy */)
+{
+  return read_nontrivial_elements(
+    r, range, std::is_same<typename Range::value_type, bool>());
+}
+
+template<typename Array>
+bool read_array(ReadStream & r, Array & array)
+{
+  return read_elements(r, array, is_memcpy_element<typename Array::value_type>());
+}
+
+template<typename Sequence>
+bool read_sequence(ReadStream & r, Sequence & sequence)
+{
+  /* every element takes at least one byte, which bounds the length before allocating */
+  uint32_t size;
+  if (!read_u32(r, size) || size > r.remaining() || size > sequence.max_size()) {
+    return false;
+  }
+  sequence.resize(size);
+  return read_elements(r, sequence, is_memcpy_element<typename Sequence::value_type>());
+}
+
+/* Entry points for GeneratedCodec */
+
+template<typename Message>
+size_t get_serialized_size(const void * message)
+{
+  SizeStream s;
+  write(s, *static_cast<const Message *>(message));
+  return 4 + s.offset();
+}
+
+template<typename Message>
+void serialize(const void * message, void * dest)
+{
+  auto header = static_cast<unsigned char *>(dest);
+  header[0] = 0;  // CDR_Legacy
+  header[1] = native_is_little_endian() ? 1 : 0;
+  header[2] = 0;
+  header[3] = 0;
+  WriteStream s(header + 4);
+  write(s, *static_cast<const Message *>(message));
+}
+
+template<typename Message>
+bool deserialize(const void * src, size_t size, void * message)
+{
+  ReadStream r(src, size);
+  return r.valid() && read(r, *static_cast<Message *>(message));
+}
+
+template<typename Message>
+const GeneratedCodec * make_generated_codec()
+{
+  static const GeneratedCodec codec {
+    RMW_CYCLONEDDS_CPP_GENERATED_CODEC_VERSION,
+    sizeof(Message),
+    &get_serialized_size<Message>,
+    &serialize<Message>,
+    &deserialize<Message>
+  };
+  return &codec;
+}
+
+}  // namespace codec
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // RMW_CYCLONEDDS_CPP__GENERATED_CODEC_HPP_
@@ -0,0 +1,63 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RMW_CYCLONEDDS_CPP__PARALLEL_TAKE_H_
+#define RMW_CYCLONEDDS_CPP__PARALLEL_TAKE_H_
+
+/* Deserializing the messages taken by rmw_take_sequence in parallel.
+
+   Normally rmw_take_sequence deserializes the messages it takes one after the other on the
+   calling thread.  For a subscription that receives large messages in bursts, e.g., point
+   clouds, that can be enabled to spread the work over several threads:
+
+     rmw_cyclonedds_cpp_set_parallel_take(subscription, 256 * 1024);
+
+   after which a batch containing a message of at least 256kB serialized is deserialized in
+   parallel.  The work is done by a small pool of threads of the RMW layer together with the
+   calling thread, unless an application-provided executor has been installed with
+   rmw_cyclonedds_cpp_set_take_executor. */
+
+#include <stddef.h>
+
+#include "rmw/rmw.h"
+#include "rmw/visibility_control.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef void (* rmw_cyclonedds_cpp_task_t)(void * task_arg, size_t index);
+
+/* Must call task(task_arg, i) for every i in [0, count), in any order and on any threads, and
+   return only when all calls have returned */
+typedef void (* rmw_cyclonedds_cpp_executor_t)(
+  rmw_cyclonedds_cpp_task_t task, void * task_arg, size_t count, void * executor_arg);
+
+/* Deserialize batches taken with rmw_take_sequence in parallel if they contain a message of at
+   least min_serialized_size bytes serialized; 0 disables it, which is the default */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_set_parallel_take(
+  const rmw_subscription_t * subscription, size_t min_serialized_size);
+
+/* Use executor to deserialize in parallel for all subscriptions; a null pointer reverts to the
+   threads of the RMW layer */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_set_take_executor(
+  rmw_cyclonedds_cpp_executor_t executor, void * executor_arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RMW_CYCLONEDDS_CPP__PARALLEL_TAKE_H_
@@ -0,0 +1,45 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RMW_CYCLONEDDS_CPP__SEQUENCE_BOUNDS_H_
+#define RMW_CYCLONEDDS_CPP__SEQUENCE_BOUNDS_H_
+
+/* Bounds for rmw_get_serialized_message_size.
+
+   rosidl does not define what a rosidl_runtime_c__Sequence__bound contains, so
+   rmw_cyclonedds_cpp accepts one whose typesupport_identifier is
+   RMW_CYCLONEDDS_CPP_SEQUENCE_BOUNDS_IDENTIFIER and whose data points to a
+   rmw_cyclonedds_cpp_sequence_bounds_t:
+
+     rmw_cyclonedds_cpp_sequence_bounds_t limits = {100, 255};
+     rosidl_runtime_c__Sequence__bound bound = {
+       RMW_CYCLONEDDS_CPP_SEQUENCE_BOUNDS_IDENTIFIER, &limits, get_sequence_bound_handle_function};
+     rmw_get_serialized_message_size(type_support, &bound, &size);
+
+   The limits apply to every unbounded field of the message, including those of nested
+   messages; bounded fields always use their own bound.  Without bounds, the size can only be
+   computed for messages that have no unbounded fields. */
+
+#include <stddef.h>
+
+#define RMW_CYCLONEDDS_CPP_SEQUENCE_BOUNDS_IDENTIFIER "rmw_cyclonedds_cpp"
+
+typedef struct rmw_cyclonedds_cpp_sequence_bounds_s
+{
+  /* maximum number of elements in an unbounded sequence */
+  size_t max_sequence_length;
+  /* maximum number of characters in an unbounded string or wstring */
+  size_t max_string_length;
+} rmw_cyclonedds_cpp_sequence_bounds_t;
+
+#endif  // RMW_CYCLONEDDS_CPP__SEQUENCE_BOUNDS_H_
@@ -0,0 +1,72 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RMW_CYCLONEDDS_CPP__TAKE_SEQUENCE_H_
+#define RMW_CYCLONEDDS_CPP__TAKE_SEQUENCE_H_
+
+/* Taking a batch of messages while also learning about the samples without data.
+
+   rmw_take_sequence silently drops samples that carry no message but only signal that the
+   publisher disposed of the data or that no publishers are left.  Taking with
+   rmw_cyclonedds_cpp_take_sequence_with_invalid returns those in a separate array, in the
+   order in which they were taken, so that a caller interested in them doesn't need a second
+   pass over the reader:
+
+     rmw_cyclonedds_cpp_invalid_sample_t invalid[16];
+     size_t taken, n_invalid;
+     rmw_cyclonedds_cpp_take_sequence_with_invalid(
+       subscription, 16, &messages, &infos, invalid, &n_invalid, &taken, NULL); */
+
+#include <stddef.h>
+
+#include "rmw/rmw.h"
+#include "rmw/visibility_control.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum rmw_cyclonedds_cpp_instance_state_e
+{
+  /* data is still being published */
+  RMW_CYCLONEDDS_CPP_INSTANCE_ALIVE,
+  /* a publisher disposed of the data */
+  RMW_CYCLONEDDS_CPP_INSTANCE_DISPOSED,
+  /* all publishers are gone */
+  RMW_CYCLONEDDS_CPP_INSTANCE_NO_WRITERS
+} rmw_cyclonedds_cpp_instance_state_t;
+
+typedef struct rmw_cyclonedds_cpp_invalid_sample_s
+{
+  /* publisher and source timestamp of the sample, as for a message */
+  rmw_message_info_t info;
+  rmw_cyclonedds_cpp_instance_state_t instance_state;
+} rmw_cyclonedds_cpp_invalid_sample_t;
+
+/* Take up to count samples like rmw_take_sequence, returning the ones that have no data in
+   invalid_samples, which must have room for count entries, and their number in n_invalid.
+   Messages and invalid samples together count towards count. */
+RMW_PUBLIC
+rmw_ret_t rmw_cyclonedds_cpp_take_sequence_with_invalid(
+  const rmw_subscription_t * subscription, size_t count,
+  rmw_message_sequence_t * message_sequence,
+  rmw_message_info_sequence_t * message_info_sequence,
+  rmw_cyclonedds_cpp_invalid_sample_t * invalid_samples, size_t * n_invalid,
+  size_t * taken, rmw_subscription_allocation_t * allocation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RMW_CYCLONEDDS_CPP__TAKE_SEQUENCE_H_
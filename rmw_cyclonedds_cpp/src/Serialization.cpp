@@ -20,7 +20,9 @@
 
 #include "Serialization.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
 #include <cstring>
 #include <limits>
 #include <memory>
@@ -29,6 +31,7 @@
 #include <vector>
 
 #include "TypeSupport2.hpp"
+#include "byteswap.hpp"
 #include "bytewise.hpp"
 
 namespace rmw_cyclonedds_cpp
@@ -50,6 +53,10 @@ struct CDRCursor
   virtual void advance(size_t n_bytes) = 0;
   // Copy bytes to the current cursor location (if needed) and advance the cursor
   virtual void put_bytes(const void * data, size_t size) = 0;
+  // Like put_bytes, but the cursor may keep a reference to the data rather than copy it
+  virtual void put_bytes_by_reference(const void * data, size_t size) {put_bytes(data, size);}
+  // Like put_bytes, but reversing the byte order of each `swap`-byte element of the data
+  virtual void put_bytes_swapped(const void * data, size_t size, size_t swap) = 0;
   virtual bool ignores_data() const = 0;
   // Move the logical origin this many places
   virtual void rebase(ptrdiff_t relative_origin) = 0;
@@ -84,6 +91,7 @@ struct SizeCursor : public CDRCursor
   size_t offset() const final {return m_offset;}
   void advance(size_t n_bytes) final {m_offset += n_bytes;}
   void put_bytes(const void *, size_t n_bytes) final {advance(n_bytes);}
+  void put_bytes_swapped(const void *, size_t n_bytes, size_t) final {advance(n_bytes);}
   bool ignores_data() const final {return true;}
   void rebase(ptrdiff_t relative_origin) override
   {
@@ -114,16 +122,278 @@ struct DataCursor : public CDRCursor
     std::memcpy(position, bytes, n_bytes);
     position = byte_offset(position, n_bytes);
   }
+  void put_bytes_swapped(const void * bytes, size_t n_bytes, size_t swap) final
+  {
+    byteswap_copy(position, bytes, n_bytes / swap, swap);
+    position = byte_offset(position, n_bytes);
+  }
   bool ignores_data() const final {return false;}
   void rebase(ptrdiff_t relative_origin) final {origin = byte_offset(origin, relative_origin);}
 };
 
+/// Writes into a serdata_rmw, growing it as needed, so that a message can be serialized in a
+/// single pass without first computing its size.
+struct GrowableCursor : public CDRCursor
+{
+  serdata_rmw & buffer;
+  ptrdiff_t origin;
+  size_t position;
+
+  explicit GrowableCursor(serdata_rmw & buffer)
+  : buffer(buffer), origin(0), position(0) {}
+
+  size_t offset() const final
+  {
+    return static_cast<size_t>(static_cast<ptrdiff_t>(position) - origin);
+  }
+  void advance(size_t n_bytes) final
+  {
+    reserve(n_bytes);
+    std::memset(byte_offset(buffer.data(), position), '\0', n_bytes);
+    position += n_bytes;
+  }
+  void put_bytes(const void * bytes, size_t n_bytes) final
+  {
+    if (n_bytes == 0) {
+      return;
+    }
+    reserve(n_bytes);
+    std::memcpy(byte_offset(buffer.data(), position), bytes, n_bytes);
+    position += n_bytes;
+  }
+  void put_bytes_swapped(const void * bytes, size_t n_bytes, size_t swap) final
+  {
+    reserve(n_bytes);
+    byteswap_copy(byte_offset(buffer.data(), position), bytes, n_bytes / swap, swap);
+    position += n_bytes;
+  }
+  bool ignores_data() const final {return false;}
+  void rebase(ptrdiff_t relative_origin) final {origin += relative_origin;}
+
+  // trim the buffer to what has actually been written
+  void finish() {buffer.resize(position);}
+
+protected:
+  void reserve(size_t n_bytes)
+  {
+    if (position + n_bytes > buffer.size()) {
+      buffer.resize(std::max(position + n_bytes, 2 * buffer.size()));
+    }
+  }
+};
+
+/// Writes into a serdata_rmw like GrowableCursor, except that large blocks of data are not
+/// copied but referenced in a list of segments. The serdata then only holds the bytes between
+/// those blocks.
+struct ScatterCursor : public CDRCursor
+{
+  serdata_rmw & buffer;
+  std::vector<serdata_rmw_segment> & segments;
+  ptrdiff_t origin;
+  // position in the buffer
+  size_t position;
+  // number of bytes referenced so far
+  size_t referenced;
+  // position in the buffer where the current run of bytes in the buffer started
+  size_t run_start;
+
+  ScatterCursor(serdata_rmw & buffer, std::vector<serdata_rmw_segment> & segments)
+  : buffer(buffer), segments(segments), origin(0), position(0), referenced(0), run_start(0) {}
+
+  size_t offset() const final
+  {
+    return static_cast<size_t>(static_cast<ptrdiff_t>(position + referenced) - origin);
+  }
+  void advance(size_t n_bytes) final
+  {
+    reserve(n_bytes);
+    std::memset(byte_offset(buffer.data(), position), '\0', n_bytes);
+    position += n_bytes;
+  }
+  void put_bytes(const void * bytes, size_t n_bytes) final
+  {
+    if (n_bytes == 0) {
+      return;
+    }
+    reserve(n_bytes);
+    std::memcpy(byte_offset(buffer.data(), position), bytes, n_bytes);
+    position += n_bytes;
+  }
+  void put_bytes_swapped(const void * bytes, size_t n_bytes, size_t swap) final
+  {
+    reserve(n_bytes);
+    byteswap_copy(byte_offset(buffer.data(), position), bytes, n_bytes / swap, swap);
+    position += n_bytes;
+  }
+  void put_bytes_by_reference(const void * bytes, size_t n_bytes) final
+  {
+    if (n_bytes < min_referenced_size) {
+      put_bytes(bytes, n_bytes);
+      return;
+    }
+    end_run();
+    segments.push_back({bytes, n_bytes});
+    referenced += n_bytes;
+  }
+  bool ignores_data() const final {return false;}
+  void rebase(ptrdiff_t relative_origin) final {origin += relative_origin;}
+
+  // trim the buffer to what has actually been written and complete the list of segments
+  void finish()
+  {
+    if (!segments.empty()) {
+      // the total size must be padded like serdata_rmw::resize does for contiguous data
+      size_t total = position + referenced;
+      if (total % 4 != 0) {
+        advance(4 - total % 4);
+      }
+      end_run();
+    }
+    buffer.resize(position);
+  }
+
+protected:
+  void reserve(size_t n_bytes)
+  {
+    if (position + n_bytes > buffer.size()) {
+      buffer.resize(std::max(position + n_bytes, 2 * buffer.size()));
+    }
+  }
+  void end_run()
+  {
+    if (position > run_start) {
+      segments.push_back({nullptr, position - run_start});
+      run_start = position;
+    }
+  }
+};
+
 enum class EncodingVersion
 {
   CDR_Legacy,
   CDR1,
 };
 
+/// What is statically known about the CDR offset at some point in a serialization program:
+/// the offset is congruent to `phase` modulo `modulus`, where modulus is a power of two.
+/// A modulus of 1 means nothing is known.
+struct AlignmentState
+{
+  size_t modulus;
+  size_t phase;
+
+  /// Number of padding bytes needed to align to `align`, which must divide the modulus
+  size_t padding_for(size_t align) const
+  {
+    assert(modulus % align == 0);
+    return (align - phase % align) % align;
+  }
+
+  void advance(size_t n_bytes) {phase = (phase + n_bytes) % modulus;}
+
+  /// The offset moves by some multiple of n_bytes not known until runtime
+  void advance_unknown_multiple(size_t n_bytes)
+  {
+    while (n_bytes % modulus != 0) {
+      modulus /= 2;
+    }
+    phase %= modulus;
+  }
+
+  /// The offset is aligned to `align` at runtime
+  void align(size_t align)
+  {
+    if (modulus % align != 0) {
+      modulus = align;
+      phase = 0;
+    } else {
+      advance(padding_for(align));
+    }
+  }
+
+  /// True if every offset described by this state is also described by `other`
+  bool implies(const AlignmentState & other) const
+  {
+    return modulus % other.modulus == 0 && phase % other.modulus == other.phase;
+  }
+
+  /// The most precise state describing every offset described by either `a` or `b`
+  static AlignmentState meet(const AlignmentState & a, const AlignmentState & b)
+  {
+    size_t m = std::min(a.modulus, b.modulus);
+    while (a.phase % m != b.phase % m) {
+      m /= 2;
+    }
+    return {m, a.phase % m};
+  }
+};
+
+struct SerializationProgram;
+
+/// One step of a compiled serialization program.
+/// Offsets are relative to the start of the object the program is run on.
+struct SerializationInstruction
+{
+  enum class Opcode
+  {
+    // zero-fill `padding` bytes, then copy `size` bytes from `offset` verbatim; or if `swap` is
+    // not 0, as elements of `swap` bytes with the byte order of each reversed
+    Memcpy,
+    // align to `size` bytes where the offset is not known at compile time
+    Align,
+    // a primitive value whose in-memory representation differs from its CDR representation
+    Primitive,
+    U8String,
+    U16String,
+    BoolVector,
+    // sequence of elements `size` bytes apart: the length, then the first element using `first`
+    // and the others using `rest`. A null `rest` means the others are copied verbatim; a null
+    // `first` means all elements are copied verbatim after `padding` bytes. Verbatim copies
+    // reverse the byte order of `swap`-byte elements like Memcpy does.
+    Sequence,
+    // `count` consecutive array elements `size` bytes apart, each serialized by `rest`
+    Repeat,
+  };
+
+  SerializationInstruction(Opcode opcode, size_t offset, const AnyValueType * value_type = nullptr)
+  : opcode(opcode), offset(offset), value_type(value_type)
+  {
+  }
+
+  Opcode opcode;
+  size_t offset;
+  const AnyValueType * value_type;
+  size_t size {0};
+  size_t padding {0};
+  size_t count {0};
+  size_t swap {0};
+  std::unique_ptr<const SerializationProgram> first;
+  std::unique_ptr<const SerializationProgram> rest;
+};
+
+struct SerializationProgram
+{
+  std::vector<SerializationInstruction> instructions;
+
+  /// True if the program copies `size` bytes from offset 0 verbatim, after `*padding` bytes;
+  /// `*swap` is set to the size of the elements whose byte order the copy reverses, or 0
+  bool is_copy_of(size_t size, size_t * padding, size_t * swap) const
+  {
+    if (instructions.size() != 1) {
+      return false;
+    }
+    auto & insn = instructions.front();
+    if (insn.opcode != SerializationInstruction::Opcode::Memcpy ||
+      insn.offset != 0 || insn.size != size)
+    {
+      return false;
+    }
+    *padding = insn.padding;
+    *swap = insn.swap;
+    return true;
+  }
+};
+
 class CDRWriter : public BaseCDRWriter
 {
 public:
@@ -148,17 +418,50 @@ public:
 
   const EncodingVersion eversion;
   const size_t max_align;
+  // byte order of the output; primitives are swapped while writing if it is not the native one
+  const endian byte_order;
+  const bool m_swap_bytes;
   std::unique_ptr<const StructValueType> m_root_value_type;
   std::unordered_map<CacheKey, bool, CacheKey::Hash> trivially_serialized_cache;
+  // the root value type compiled into a flat instruction stream; this is what serialization
+  // actually runs so the type tree need not be walked for every message
+  SerializationProgram m_program;
+  size_t m_fixed_serialized_size;
+  bool m_is_memcpy_serialized;
+  bool m_may_reference_data;
 
 public:
-  explicit CDRWriter(std::unique_ptr<const StructValueType> root_value_type)
+  explicit CDRWriter(
+    std::unique_ptr<const StructValueType> root_value_type,
+    endian byte_order = native_endian())
   : eversion{EncodingVersion::CDR_Legacy}, max_align{8},
+    byte_order{byte_order}, m_swap_bytes{byte_order != native_endian()},
     m_root_value_type{std::move(root_value_type)},
     trivially_serialized_cache{}
   {
     assert(m_root_value_type);
     register_serializable_type(m_root_value_type.get());
+    // both plain messages and requests (following the 16-byte request header) start at offset 0
+    // modulo max_align relative to the rebased origin
+    AlignmentState state{max_align, 0};
+    compile(m_program, m_root_value_type.get(), 0, state);
+
+    size_t padding, swap;
+    m_is_memcpy_serialized = eversion == EncodingVersion::CDR_Legacy &&
+      m_root_value_type->n_members() > 0 &&
+      m_program.is_copy_of(m_root_value_type->sizeof_struct(), &padding, &swap) &&
+      padding == 0 && swap == 0;
+
+    SizeCursor cursor;
+    if (m_root_value_type->n_members() == 0) {
+      m_fixed_serialized_size = get_serialized_size(nullptr);
+    } else if (compute_fixed_size(&cursor, m_program)) {
+      // header, then the data relative to the rebased origin
+      m_fixed_serialized_size = 4 + cursor.offset();
+    } else {
+      m_fixed_serialized_size = 0;
+    }
+    m_may_reference_data = has_large_copies(m_program);
   }
 
   void register_serializable_type(const AnyValueType * t)
@@ -217,6 +520,12 @@ public:
 
   void serialize(void * dest, const void * data) const override
   {
+    if (m_is_memcpy_serialized) {
+      DataCursor cursor(dest);
+      put_rtps_header(&cursor);
+      std::memcpy(cursor.position, data, m_root_value_type->sizeof_struct());
+      return;
+    }
     DataCursor cursor(dest);
     serialize_top_level(&cursor, data);
   }
@@ -236,6 +545,37 @@ public:
     serialize_top_level(&cursor, request);
   }
 
+  void serialize(serdata_rmw & dest, const void * data) const override
+  {
+    GrowableCursor cursor(dest);
+    serialize_top_level(&cursor, data);
+    cursor.finish();
+  }
+
+  void serialize(serdata_rmw & dest, const cdds_request_wrapper_t & request) const override
+  {
+    GrowableCursor cursor(dest);
+    serialize_top_level(&cursor, request);
+    cursor.finish();
+  }
+
+  void serialize(
+    serdata_rmw & dest, std::vector<serdata_rmw_segment> & segments,
+    const void * data) const override
+  {
+    ScatterCursor cursor(dest, segments);
+    serialize_top_level(&cursor, data);
+    cursor.finish();
+  }
+
+  size_t get_fixed_serialized_size() const override {return m_fixed_serialized_size;}
+
+  bool is_memcpy_serialized() const override {return m_is_memcpy_serialized;}
+
+  bool may_reference_data() const override {return m_may_reference_data;}
+
+  const StructValueType & root_value_type() const override {return *m_root_value_type;}
+
   void serialize_top_level(
     CDRCursor * cursor, const void * data) const
   {
@@ -249,7 +589,7 @@ public:
       char dummy = '\0';
       cursor->put_bytes(&dummy, 1);
     } else {
-      serialize(cursor, data, m_root_value_type.get());
+      serialize(cursor, data, m_program);
     }
 
     if (eversion == EncodingVersion::CDR_Legacy) {
@@ -264,10 +604,10 @@ public:
     if (eversion == EncodingVersion::CDR_Legacy) {
       cursor->rebase(+4);
     }
-    cursor->put_bytes(&request.header.guid, sizeof(request.header.guid));
-    cursor->put_bytes(&request.header.seq, sizeof(request.header.seq));
+    put_primitive(cursor, &request.header.guid, sizeof(request.header.guid));
+    put_primitive(cursor, &request.header.seq, sizeof(request.header.seq));
 
-    serialize(cursor, request.data, m_root_value_type.get());
+    serialize(cursor, request.data, m_program);
 
     if (eversion == EncodingVersion::CDR_Legacy) {
       cursor->rebase(-4);
@@ -291,7 +631,7 @@ protected:
     }
     std::array<char, 4> rtps_header{{eversion_byte,
       // encoding format = PLAIN_CDR
-      (native_endian() == endian::little) ? '\1' : '\0',
+      (byte_order == endian::little) ? '\1' : '\0',
       // options
       '\0', '\0'}};
     cursor->put_bytes(rtps_header.data(), rtps_header.size());
@@ -302,7 +642,17 @@ protected:
     assert(value <= std::numeric_limits<uint32_t>::max());
     auto u32_value = static_cast<uint32_t>(value);
     cursor->align(4);
-    cursor->put_bytes(&u32_value, 4);
+    put_primitive(cursor, &u32_value, 4);
+  }
+
+  /// Write a primitive value of `n_bytes` bytes in the output byte order
+  void put_primitive(CDRCursor * cursor, const void * data, size_t n_bytes) const
+  {
+    if (m_swap_bytes && n_bytes > 1) {
+      cursor->put_bytes_swapped(data, n_bytes, n_bytes);
+    } else {
+      cursor->put_bytes(data, n_bytes);
+    }
   }
 
   static size_t get_cdr_size_of_primitive(ROSIDL_TypeKind tk)
@@ -364,19 +714,13 @@ protected:
     if (align % cdr_alignof != 0) {
       return false;
     }
+    // a copy of a multi-byte value has the wrong byte order when swapping
+    if (m_swap_bytes && cdr_alignof > 1) {
+      return false;
+    }
     return v.sizeof_type() == get_cdr_size_of_primitive(v.type_kind());
   }
 
-  bool lookup_many_trivially_serialized(size_t align, const AnyValueType * evt) const
-  {
-    align %= max_align;
-    // CLEVERNESS ALERT
-    // we take advantage of the fact that if something is aligned at offset A and at offset A+N
-    // then the alignment requirement of its elements divides A+k*N for all k
-    return lookup_trivially_serialized(align, evt) &&
-           lookup_trivially_serialized((align + evt->sizeof_type()) % max_align, evt);
-  }
-
   bool compute_trivially_serialized(size_t align, const ArrayValueType & v) const
   {
     auto evt = v.element_value_type();
@@ -439,15 +783,15 @@ protected:
     switch (value_type.type_kind()) {
       case ROSIDL_TypeKind::FLOAT:
         assert(std::numeric_limits<float>::is_iec559);
-        cursor->put_bytes(data, n_bytes);
+        put_primitive(cursor, data, n_bytes);
         return;
       case ROSIDL_TypeKind::DOUBLE:
         assert(std::numeric_limits<double>::is_iec559);
-        cursor->put_bytes(data, n_bytes);
+        put_primitive(cursor, data, n_bytes);
         return;
       case ROSIDL_TypeKind::LONG_DOUBLE:
         assert(std::numeric_limits<long double>::is_iec559);
-        cursor->put_bytes(data, n_bytes);
+        put_primitive(cursor, data, n_bytes);
         return;
       case ROSIDL_TypeKind::CHAR:
       case ROSIDL_TypeKind::WCHAR:
@@ -462,10 +806,10 @@ protected:
       case ROSIDL_TypeKind::UINT64:
       case ROSIDL_TypeKind::INT64:
         if (value_type.sizeof_type() == n_bytes || native_endian() == endian::little) {
-          cursor->put_bytes(data, n_bytes);
+          put_primitive(cursor, data, n_bytes);
         } else {
           const void * offset_data = byte_offset(data, value_type.sizeof_type() - n_bytes);
-          cursor->put_bytes(offset_data, n_bytes);
+          put_primitive(cursor, offset_data, n_bytes);
         }
         return;
       case ROSIDL_TypeKind::STRING:
@@ -494,31 +838,19 @@ protected:
         cursor->advance(sizeof(wchar_t) * str.size());
       } else {
         for (wchar_t c : str) {
-          cursor->put_bytes(&c, sizeof(wchar_t));
+          put_primitive(cursor, &c, sizeof(wchar_t));
         }
       }
     } else {
       serialize_u32(cursor, str.size_bytes());
-      cursor->put_bytes(str.data(), str.size_bytes());
+      if (m_swap_bytes) {
+        cursor->put_bytes_swapped(str.data(), str.size_bytes(), sizeof(char16_t));
+      } else {
+        cursor->put_bytes(str.data(), str.size_bytes());
+      }
     }
   }
 
-  void serialize(CDRCursor * cursor, const void * data, const ArrayValueType & value_type) const
-  {
-    serialize_many(
-      cursor, value_type.get_data(data), value_type.array_size(), value_type.element_value_type());
-  }
-
-  void serialize(
-    CDRCursor * cursor, const void * data,
-    const SpanSequenceValueType & value_type) const
-  {
-    size_t count = value_type.sequence_size(data);
-    serialize_u32(cursor, count);
-    serialize_many(
-      cursor, value_type.sequence_contents(data), count, value_type.element_value_type());
-  }
-
   void serialize(
     CDRCursor * cursor, const void * data,
     const BoolVectorValueType & value_type) const
@@ -535,87 +867,359 @@ protected:
     }
   }
 
-  void serialize(CDRCursor * cursor, const void * data, const AnyValueType * value_type) const
+  /// True if a verbatim copy serializes the value at any offset described by `state`
+  bool is_trivially_serialized_at(const AlignmentState & state, const AnyValueType * p) const
   {
-    if (lookup_trivially_serialized(cursor->offset(), value_type)) {
-      cursor->put_bytes(data, value_type->sizeof_type());
-    } else {
-//      value_type->apply([&](const auto & vt) {return serialize(cursor, data, vt);});
-      if (auto s = dynamic_cast<const PrimitiveValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
-      }
-      if (auto s = dynamic_cast<const U8StringValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
-      }
-      if (auto s = dynamic_cast<const U16StringValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
-      }
-      if (auto s = dynamic_cast<const StructValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
-      }
-      if (auto s = dynamic_cast<const ArrayValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
-      }
-      if (auto s = dynamic_cast<const SpanSequenceValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
-      }
-      if (auto s = dynamic_cast<const BoolVectorValueType *>(value_type)) {
-        return serialize(cursor, data, *s);
+    for (size_t align = state.phase; align < max_align; align += state.modulus) {
+      if (!lookup_trivially_serialized(align, p)) {
+        return false;
       }
-      unreachable();
     }
+    return true;
   }
 
-  void serialize_many(
-    CDRCursor * cursor, const void * data, size_t count,
-    const AnyValueType * vt) const
+  static void emit_copy(
+    SerializationProgram & program, size_t padding, size_t offset,
+    size_t n_bytes, size_t swap = 0)
   {
-    // nothing to do; not even alignment
-    if (count == 0) {
+    using Opcode = SerializationInstruction::Opcode;
+    auto & insns = program.instructions;
+    // extend the previous copy if this one continues it both in memory and in the CDR stream
+    if (padding == 0 && !insns.empty() && insns.back().opcode == Opcode::Memcpy &&
+      insns.back().offset + insns.back().size == offset && insns.back().swap == swap)
+    {
+      insns.back().size += n_bytes;
       return;
     }
+    insns.emplace_back(Opcode::Memcpy, offset);
+    insns.back().padding = padding;
+    insns.back().size = n_bytes;
+    insns.back().swap = swap;
+  }
 
-    // Serialize the first element.
-    serialize(cursor, data, vt);
+  /// Append the instructions for serializing a value located at `offset`.
+  /// On entry `state` describes the CDR offset before the value, on return the one after it.
+  void compile(
+    SerializationProgram & program, const AnyValueType * value_type, size_t offset,
+    AlignmentState & state) const
+  {
+    if (is_trivially_serialized_at(state, value_type)) {
+      emit_copy(program, 0, offset, value_type->sizeof_type());
+      state.advance(value_type->sizeof_type());
+      return;
+    }
 
-    // If the value type is primitive, we are now aligned.
-    // It might be that the first element is not trivially serialized but the rest are;
-    // e.g. if any element in a struct has CDR alignment more stringent than the first element.
+    using Opcode = SerializationInstruction::Opcode;
+    switch (value_type->e_value_type()) {
+      case EValueType::PrimitiveValueType:
+        compile(program, *static_cast<const PrimitiveValueType *>(value_type), offset, state);
+        break;
+      case EValueType::StructValueType: {
+          auto & struct_info = *static_cast<const StructValueType *>(value_type);
+          for (size_t i = 0; i < struct_info.n_members(); i++) {
+            auto member_info = struct_info.get_member(i);
+            compile(program, member_info->value_type, offset + member_info->member_offset, state);
+          }
+        }
+        break;
+      case EValueType::ArrayValueType:
+        compile(program, *static_cast<const ArrayValueType *>(value_type), offset, state);
+        break;
+      case EValueType::SpanSequenceValueType:
+        compile(program, *static_cast<const SpanSequenceValueType *>(value_type), offset, state);
+        break;
+      case EValueType::U8StringValueType:
+        program.instructions.emplace_back(Opcode::U8String, offset, value_type);
+        state.align(4);
+        state.advance(4);
+        state.advance_unknown_multiple(1);
+        break;
+      case EValueType::U16StringValueType:
+        program.instructions.emplace_back(Opcode::U16String, offset, value_type);
+        state.align(4);
+        state.advance(4);
+        state.advance_unknown_multiple(
+          eversion == EncodingVersion::CDR_Legacy ? sizeof(wchar_t) : sizeof(char16_t));
+        break;
+      case EValueType::BoolVectorValueType:
+        program.instructions.emplace_back(Opcode::BoolVector, offset, value_type);
+        state.align(4);
+        state.advance(4);
+        state.advance_unknown_multiple(1);
+        break;
+      default:
+        unreachable();
+    }
+  }
 
-    data = byte_offset(data, vt->sizeof_type());
-    --count;
+  void compile(
+    SerializationProgram & program, const PrimitiveValueType & value_type, size_t offset,
+    AlignmentState & state) const
+  {
+    using Opcode = SerializationInstruction::Opcode;
+    size_t align = get_cdr_alignof_primitive(value_type.type_kind());
+    size_t n_bytes = get_cdr_size_of_primitive(value_type.type_kind());
+    if (value_type.sizeof_type() != n_bytes) {
+      program.instructions.emplace_back(Opcode::Primitive, offset, &value_type);
+      state.align(align);
+      state.advance(n_bytes);
+      return;
+    }
+    if (state.modulus % align != 0) {
+      program.instructions.emplace_back(Opcode::Align, 0);
+      program.instructions.back().size = align;
+      state.align(align);
+    }
+    size_t padding = state.padding_for(align);
+    emit_copy(program, padding, offset, n_bytes, (m_swap_bytes && n_bytes > 1) ? n_bytes : 0);
+    state.advance(padding + n_bytes);
+  }
+
+  void compile(
+    SerializationProgram & program, const ArrayValueType & value_type, size_t offset,
+    AlignmentState & state) const
+  {
+    using Opcode = SerializationInstruction::Opcode;
+    size_t count = value_type.array_size();
     if (count == 0) {
       return;
     }
+    auto element_type = value_type.element_value_type();
+    size_t element_size = element_type->sizeof_type();
 
-    if (lookup_many_trivially_serialized(cursor->offset(), vt)) {
-      size_t value_size = vt->sizeof_type();
-      cursor->put_bytes(data, count * value_size);
+    // The first element is inlined. It might be that it is not trivially serialized but the rest
+    // are; e.g. if any element in a struct has CDR alignment more stringent than the first element.
+    compile(program, element_type, offset, state);
+    if (count == 1) {
       return;
+    }
+    auto rest = compile_rest(element_type, state);
+    size_t padding, swap;
+    if (rest->is_copy_of(element_size, &padding, &swap) && padding == 0) {
+      emit_copy(program, 0, offset + element_size, (count - 1) * element_size, swap);
     } else {
-      for (size_t i = 0; i < count; i++) {
-        auto element = byte_offset(data, i * vt->sizeof_type());
-        serialize(cursor, element, vt);
+      program.instructions.emplace_back(Opcode::Repeat, offset + element_size);
+      auto & insn = program.instructions.back();
+      insn.size = element_size;
+      insn.count = count - 1;
+      insn.rest = std::move(rest);
+    }
+  }
+
+  void compile(
+    SerializationProgram & program, const SpanSequenceValueType & value_type, size_t offset,
+    AlignmentState & state) const
+  {
+    using Opcode = SerializationInstruction::Opcode;
+    auto element_type = value_type.element_value_type();
+    size_t element_size = element_type->sizeof_type();
+
+    // the length
+    state.align(4);
+    state.advance(4);
+    AlignmentState after_length = state;
+
+    auto first = std::make_unique<SerializationProgram>();
+    compile(*first, element_type, 0, state);
+    AlignmentState after_first = state;
+    auto rest = compile_rest(element_type, state);
+
+    program.instructions.emplace_back(Opcode::Sequence, offset, &value_type);
+    auto & insn = program.instructions.back();
+    insn.size = element_size;
+    size_t padding, swap, first_swap;
+    if (rest->is_copy_of(element_size, &padding, &swap) && padding == 0) {
+      rest.reset();
+      insn.swap = swap;
+      if (first->is_copy_of(element_size, &padding, &first_swap) && first_swap == swap) {
+        first.reset();
+        insn.padding = padding;
       }
     }
+    insn.first = std::move(first);
+    insn.rest = std::move(rest);
+
+    // there may be zero, one, or many elements
+    state = AlignmentState::meet(after_length, AlignmentState::meet(after_first, state));
+  }
+
+  /// Compile the program for the elements following the first one in an array or sequence.
+  /// On entry `state` describes the offset after the first element, on return the offset after
+  /// one or more of the following elements.
+  std::unique_ptr<SerializationProgram> compile_rest(
+    const AnyValueType * element_type,
+    AlignmentState & state) const
+  {
+    // Weaken the assumed entry state until it also holds after an element; this takes at most
+    // log2(max_align) rounds.
+    while (true) {
+      auto program = std::make_unique<SerializationProgram>();
+      AlignmentState exit_state = state;
+      compile(*program, element_type, 0, exit_state);
+      if (exit_state.implies(state)) {
+        state = exit_state;
+        return program;
+      }
+      state = AlignmentState::meet(state, exit_state);
+    }
+  }
+
+  /// True if the program may copy blocks large enough for ScatterCursor to reference them
+  static bool has_large_copies(const SerializationProgram & program)
+  {
+    using Opcode = SerializationInstruction::Opcode;
+    for (const auto & insn : program.instructions) {
+      switch (insn.opcode) {
+        case Opcode::Memcpy:
+          // swapped bytes are written into the buffer, never referenced
+          if (insn.swap == 0 && insn.size >= min_referenced_size) {
+            return true;
+          }
+          break;
+        case Opcode::Sequence:
+          // the size of a verbatim copy of the elements depends on the data, whether it is
+          // large enough is decided for each message when publishing
+          if (insn.swap == 0 && (!insn.first || !insn.rest)) {
+            return true;
+          }
+          if ((insn.first && has_large_copies(*insn.first)) ||
+            (insn.rest && has_large_copies(*insn.rest)))
+          {
+            return true;
+          }
+          break;
+        case Opcode::Repeat:
+          if (has_large_copies(*insn.rest)) {
+            return true;
+          }
+          break;
+        default:
+          break;
+      }
+    }
+    return false;
+  }
+
+  /// Advance the cursor by the serialized size of the program, provided that size does not
+  /// depend on the data. Returns false if it does.
+  bool compute_fixed_size(CDRCursor * cursor, const SerializationProgram & program) const
+  {
+    using Opcode = SerializationInstruction::Opcode;
+    for (const auto & insn : program.instructions) {
+      switch (insn.opcode) {
+        case Opcode::Memcpy:
+          cursor->advance(insn.padding + insn.size);
+          break;
+        case Opcode::Align:
+          cursor->align(insn.size);
+          break;
+        case Opcode::Primitive: {
+            auto tk = static_cast<const PrimitiveValueType *>(insn.value_type)->type_kind();
+            cursor->align(get_cdr_alignof_primitive(tk));
+            cursor->advance(get_cdr_size_of_primitive(tk));
+          }
+          break;
+        case Opcode::Repeat:
+          for (size_t i = 0; i < insn.count; i++) {
+            if (!compute_fixed_size(cursor, *insn.rest)) {
+              return false;
+            }
+          }
+          break;
+        case Opcode::U8String:
+        case Opcode::U16String:
+        case Opcode::BoolVector:
+        case Opcode::Sequence:
+          return false;
+        default:
+          unreachable();
+      }
+    }
+    return true;
+  }
+
+  /// Write a verbatim copy of data, reversing the byte order of `swap`-byte elements if not 0
+  static void put_copy(CDRCursor * cursor, const void * data, size_t n_bytes, size_t swap)
+  {
+    if (swap != 0) {
+      cursor->put_bytes_swapped(data, n_bytes, swap);
+    } else {
+      cursor->put_bytes_by_reference(data, n_bytes);
+    }
   }
 
   void serialize(
-    CDRCursor * cursor, const void * struct_data,
-    const StructValueType & struct_info) const
+    CDRCursor * cursor, const void * data,
+    const SerializationProgram & program) const
   {
-    for (size_t i = 0; i < struct_info.n_members(); i++) {
-      auto member_info = struct_info.get_member(i);
-      auto value_type = member_info->value_type;
-      auto member_data = byte_offset(struct_data, member_info->member_offset);
-      serialize(cursor, member_data, value_type);
+    using Opcode = SerializationInstruction::Opcode;
+    for (const auto & insn : program.instructions) {
+      const void * field = byte_offset(data, insn.offset);
+      switch (insn.opcode) {
+        case Opcode::Memcpy:
+          if (insn.padding != 0) {
+            cursor->advance(insn.padding);
+          }
+          put_copy(cursor, field, insn.size, insn.swap);
+          break;
+        case Opcode::Align:
+          cursor->align(insn.size);
+          break;
+        case Opcode::Primitive:
+          serialize(cursor, field, *static_cast<const PrimitiveValueType *>(insn.value_type));
+          break;
+        case Opcode::U8String:
+          serialize(cursor, field, *static_cast<const U8StringValueType *>(insn.value_type));
+          break;
+        case Opcode::U16String:
+          serialize(cursor, field, *static_cast<const U16StringValueType *>(insn.value_type));
+          break;
+        case Opcode::BoolVector:
+          serialize(cursor, field, *static_cast<const BoolVectorValueType *>(insn.value_type));
+          break;
+        case Opcode::Sequence: {
+            auto value_type = static_cast<const SpanSequenceValueType *>(insn.value_type);
+            size_t count = value_type->sequence_size(field);
+            serialize_u32(cursor, count);
+            // nothing more to do; not even alignment
+            if (count == 0) {
+              break;
+            }
+            const void * contents = value_type->sequence_contents(field);
+            if (!insn.first) {
+              if (insn.padding != 0) {
+                cursor->advance(insn.padding);
+              }
+              put_copy(cursor, contents, count * insn.size, insn.swap);
+              break;
+            }
+            serialize(cursor, contents, *insn.first);
+            if (!insn.rest) {
+              put_copy(
+                cursor, byte_offset(contents, insn.size), (count - 1) * insn.size, insn.swap);
+            } else {
+              for (size_t i = 1; i < count; i++) {
+                serialize(cursor, byte_offset(contents, i * insn.size), *insn.rest);
+              }
+            }
+          }
+          break;
+        case Opcode::Repeat:
+          for (size_t i = 0; i < insn.count; i++) {
+            serialize(cursor, byte_offset(field, i * insn.size), *insn.rest);
+          }
+          break;
+        default:
+          unreachable();
+      }
     }
   }
 };
 
-std::unique_ptr<BaseCDRWriter> make_cdr_writer(std::unique_ptr<StructValueType> value_type)
+std::unique_ptr<BaseCDRWriter> make_cdr_writer(
+  std::unique_ptr<StructValueType> value_type, endian byte_order)
 {
-  return std::make_unique<CDRWriter>(std::move(value_type));
+  return std::make_unique<CDRWriter>(std::move(value_type), byte_order);
 }
 
 }  // namespace rmw_cyclonedds_cpp
@@ -15,8 +15,10 @@
 #define SERIALIZATION_HPP_
 
 #include <memory>
+#include <vector>
 
 #include "TypeSupport2.hpp"
+#include "bytewise.hpp"
 #include "rosidl_runtime_c/service_type_support_struct.h"
 #include "serdata.hpp"
 
@@ -30,10 +32,37 @@ public:
   virtual void serialize(void * dest, const void * data) const = 0;
   virtual size_t get_serialized_size(const cdds_request_wrapper_t & request) const = 0;
   virtual void serialize(void * dest, const cdds_request_wrapper_t & request) const = 0;
+  /// Serialize in a single pass into `dest`, growing it as needed. The initial size of `dest`
+  /// only serves as a hint for the capacity; on return its size is the serialized size.
+  virtual void serialize(serdata_rmw & dest, const void * data) const = 0;
+  virtual void serialize(serdata_rmw & dest, const cdds_request_wrapper_t & request) const = 0;
+  /// Like serializing into `dest` in a single pass, but large blocks of data in the message may
+  /// be referenced in `segments` instead of being copied. `dest` then holds the bytes between
+  /// them, and `segments` stays empty if nothing was referenced.
+  virtual void serialize(
+    serdata_rmw & dest, std::vector<serdata_rmw_segment> & segments,
+    const void * data) const = 0;
+  /// Serialized size of a message (without request header) if it is the same for all messages
+  /// of this type, 0 otherwise
+  virtual size_t get_fixed_serialized_size() const = 0;
+  /// True if a message is serialized as the encapsulation header followed by a verbatim copy
+  /// of the message
+  virtual bool is_memcpy_serialized() const = 0;
+  /// True if serializing into segments may reference part of a message
+  virtual bool may_reference_data() const = 0;
+  /// The type of the messages this serializes
+  virtual const StructValueType & root_value_type() const = 0;
   virtual ~BaseCDRWriter() = default;
 };
 
-std::unique_ptr<BaseCDRWriter> make_cdr_writer(std::unique_ptr<StructValueType> value_type);
+/// When serializing into segments, blocks smaller than this are copied rather than referenced:
+/// anything smaller is cheaper to copy than to send as a separate piece
+constexpr size_t min_referenced_size = 16384;
+
+/// Make a writer for messages of the type; it writes them in native byte order unless another
+/// byte order is requested
+std::unique_ptr<BaseCDRWriter> make_cdr_writer(
+  std::unique_ptr<StructValueType> value_type, endian byte_order = native_endian());
 }  // namespace rmw_cyclonedds_cpp
 
 #endif  // SERIALIZATION_HPP_
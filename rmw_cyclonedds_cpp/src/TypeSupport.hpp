@@ -17,11 +17,19 @@
 #define TYPESUPPORT_HPP_
 
 #include <cassert>
-#include <string>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "rcutils/logging_macros.h"
 
+#include "rmw_cyclonedds_cpp/sequence_bounds.h"
+
 #include "rosidl_runtime_c/string.h"
 #include "rosidl_runtime_c/string_functions.h"
 #include "rosidl_runtime_c/u16string_functions.h"
@@ -46,6 +54,35 @@ namespace rmw_cyclonedds_cpp
 template<typename MembersType>
 struct StringHelper;
 
+// Deserialize a string straight into a rosidl_runtime_c__String, overwriting the existing
+// buffer if it is large enough instead of allocating a new one.
+inline void deserialize_c_string(cycdeser & deser, rosidl_runtime_c__String & c_str)
+{
+  size_t len;
+  const char * str = deser.deserialize_string_data(len);
+  if (c_str.data != nullptr && len < c_str.capacity) {
+    memcpy(c_str.data, str, len);
+    c_str.data[len] = '\0';
+    c_str.size = len;
+  } else if (!rosidl_runtime_c__String__assignn(&c_str, str, len)) {
+    throw std::runtime_error("unable to assign rosidl_runtime_c__String");
+  }
+}
+
+// Deserialize a wide string straight into a rosidl_runtime_c__U16String, reusing its buffer in
+// the same way.
+inline void deserialize_c_u16string(cycdeser & deser, rosidl_runtime_c__U16String & c_str)
+{
+  const uint32_t len = deser.deserialize_len(sizeof(wchar_t));
+  if (c_str.data != nullptr && len < c_str.capacity) {
+    c_str.data[len] = 0;
+    c_str.size = len;
+  } else if (!rosidl_runtime_c__U16String__resize(&c_str, len)) {
+    throw std::runtime_error("unable to resize rosidl_runtime_c__U16String");
+  }
+  deser.deserialize_wchars(c_str.data, len);
+}
+
 // For C introspection typesupport we create intermediate instances of std::string so that
 // cycser/cycdeser can handle the string properly.
 template<>
@@ -78,10 +115,7 @@ struct StringHelper<rosidl_typesupport_introspection_c__MessageMembers>
 
   static void assign(cycdeser & deser, void * field)
   {
-    std::string str;
-    deser >> str;
-    rosidl_runtime_c__String * c_str = static_cast<rosidl_runtime_c__String *>(field);
-    rosidl_runtime_c__String__assign(c_str, str.c_str());
+    deserialize_c_string(deser, *static_cast<rosidl_runtime_c__String *>(field));
   }
 };
 
@@ -103,6 +137,57 @@ struct StringHelper<rosidl_typesupport_introspection_cpp::MessageMembers>
   }
 };
 
+// Precomputed deserializer for a message type.  The introspection data is walked once: nested
+// messages are flattened into the containing message, the function for each field is looked up
+// in advance, and consecutive primitive fields with the same layout in CDR as in memory are
+// merged so they can be deserialized with a single memcpy.
+template<typename MembersType>
+class DeserializationPlan
+{
+public:
+  explicit DeserializationPlan(const MembersType * members);
+  void deserialize(cycdeser & deser, void * ros_message) const;
+
+private:
+  using MemberType = typename std::remove_pointer<decltype(MembersType::members_)>::type;
+
+  struct Field
+  {
+    const MemberType * member;
+    size_t offset;
+    void (* deserialize)(const Field & field, void * data, cycdeser & deser);
+    // size and alignment in CDR if it is a primitive or an array of primitives that may be
+    // copied verbatim, size is 0 otherwise
+    size_t size;
+    size_t align;
+    // for arrays and sequences of messages
+    std::unique_ptr<const DeserializationPlan> element_plan;
+  };
+
+  // a run of fields, stored contiguously in CDR and in memory if size != 0 and the position in
+  // the CDR stream modulo 8 is one of the phases
+  struct Step
+  {
+    size_t first_field;
+    size_t n_fields;
+    size_t offset;
+    size_t size;
+    size_t align;
+    uint8_t phases;
+  };
+
+  void add_fields(const MembersType * members, size_t offset);
+  uint8_t valid_phases(size_t first_field, size_t n_fields) const;
+
+  template<typename T>
+  static void deserialize_field_as(const Field & field, void * data, cycdeser & deser);
+  static void deserialize_message_array(const Field & field, void * data, cycdeser & deser);
+  static void deserialize_unknown(const Field & field, void * data, cycdeser & deser);
+
+  std::vector<Field> fields_;
+  std::vector<Step> steps_;
+};
+
 template<typename MembersType>
 class TypeSupport
 {
@@ -114,7 +199,14 @@ public:
     cycprint & deser,
     std::function<void(cycprint &)> prefix = nullptr);
   std::string getName();
+  const MembersType * getMembers() const {return members_;}
   bool is_type_self_contained();
+  // Largest serialized size of a message of this type, encapsulation header included, with the
+  // unbounded fields limited by bounds.  False if it has unbounded fields and bounds is null.
+  bool get_max_serialized_size(
+    const rmw_cyclonedds_cpp_sequence_bounds_t * bounds, size_t & size);
+  // Precompute how to deserialize the type, for instances that are used repeatedly
+  void buildDeserializationPlan();
   virtual ~TypeSupport() = default;
 
 protected:
@@ -124,6 +216,7 @@ protected:
 
   const MembersType * members_;
   std::string name;
+  std::unique_ptr<const DeserializationPlan<MembersType>> plan_;
 
 private:
   bool deserializeROSmessage(
@@ -131,6 +224,9 @@ private:
   bool printROSmessage(
     cycprint & deser, const MembersType * members);
   bool is_type_self_contained(const MembersType * members);
+  bool get_max_serialized_size(
+    const MembersType * members, const rmw_cyclonedds_cpp_sequence_bounds_t * bounds,
+    size_t & offset);
 };
 
 size_t get_message_size(
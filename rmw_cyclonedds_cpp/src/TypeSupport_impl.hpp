@@ -16,7 +16,9 @@
 #ifndef TYPESUPPORT_IMPL_HPP_
 #define TYPESUPPORT_IMPL_HPP_
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <functional>
 #include <string>
 #include <vector>
@@ -35,7 +37,6 @@
 #include "rosidl_runtime_c/u16string_functions.h"
 
 #include "serdes.hpp"
-#include "u16string.hpp"
 
 namespace rmw_cyclonedds_cpp
 {
@@ -88,6 +89,31 @@ inline void resize_field(
   member->resize_function(field, size);
 }
 
+// Layout shared by all rosidl C sequence types
+struct CSequenceView
+{
+  void * data;
+  size_t size;
+  size_t capacity;
+};
+
+// Deserializing into a C sequence reuses its buffer if it has room for the new elements, so
+// that taking messages into the same instance over and over does not allocate once the
+// sequences have grown to their steady-state size.  The elements between the size and the
+// capacity remain initialized: the __fini functions of the sequences finalize all of them.
+template<typename Sequence, typename Init, typename Fini>
+void resize_c_sequence(Sequence & sequence, size_t size, Init init, Fini fini)
+{
+  if (size <= sequence.capacity) {
+    sequence.size = size;
+    return;
+  }
+  fini(&sequence);
+  if (!init(&sequence, size)) {
+    throw std::runtime_error("unable to initialize sequence");
+  }
+}
+
 inline void resize_field(
   const rosidl_typesupport_introspection_c__MessageMember * member,
   void * field,
@@ -97,6 +123,11 @@ inline void resize_field(
     throw std::runtime_error("unexpected error: resize function is null");
   }
 
+  auto sequence = static_cast<CSequenceView *>(field);
+  if (size <= sequence->capacity) {
+    sequence->size = size;
+    return;
+  }
   if (!member->resize_function(field, size)) {
     throw std::runtime_error("unable to resize field");
   }
@@ -141,11 +172,8 @@ inline void deserialize_field<std::wstring>(
   void * field,
   cycdeser & deser)
 {
-  std::wstring wstr;
   if (!member->is_array_) {
-    deser >> wstr;
-    wstring_to_u16string(
-      wstr, *static_cast<std::u16string *>(field));
+    deser >> *static_cast<std::u16string *>(field);
   } else {
     uint32_t size;
     if (member->array_size_ && !member->is_upper_bound_) {
@@ -156,9 +184,7 @@ inline void deserialize_field<std::wstring>(
     }
     for (size_t i = 0; i < size; ++i) {
       void * element = member->get_function(field, i);
-      auto u16str = static_cast<std::u16string *>(element);
-      deser >> wstr;
-      wstring_to_u16string(wstr, *u16str);
+      deser >> *static_cast<std::u16string *>(element);
     }
   }
 }
@@ -175,11 +201,8 @@ void deserialize_field(
     deser.deserializeA(static_cast<T *>(field), member->array_size_);
   } else {
     auto & data = *reinterpret_cast<typename GenericCSequence<T>::type *>(field);
-    int32_t dsize = 0;
-    deser >> dsize;
-    if (!GenericCSequence<T>::init(&data, dsize)) {
-      throw std::runtime_error("unable initialize generic sequence");
-    }
+    const uint32_t dsize = deser.deserialize_len(sizeof(T));
+    resize_c_sequence(data, dsize, GenericCSequence<T>::init, GenericCSequence<T>::fini);
     deser.deserializeA(reinterpret_cast<T *>(data.data), dsize);
   }
 }
@@ -196,34 +219,17 @@ inline void deserialize_field<std::string>(
   } else {
     if (member->array_size_ && !member->is_upper_bound_) {
       auto deser_field = static_cast<rosidl_runtime_c__String *>(field);
-      // tmpstring is defined here and not below to avoid
-      // memory allocation in every iteration of the for loop
-      std::string tmpstring;
       for (size_t i = 0; i < member->array_size_; ++i) {
-        deser.deserialize(tmpstring);
-        if (!rosidl_runtime_c__String__assign(&deser_field[i], tmpstring.c_str())) {
-          throw std::runtime_error("unable to assign rosidl_runtime_c__String");
-        }
+        deserialize_c_string(deser, deser_field[i]);
       }
     } else {
-      std::vector<std::string> cpp_string_vector;
-      deser >> cpp_string_vector;
-
-      auto & string_array_field = *reinterpret_cast<rosidl_runtime_c__String__Sequence *>(field);
-      if (
-        !rosidl_runtime_c__String__Sequence__init(
-          &string_array_field, cpp_string_vector.size()))
-      {
-        throw std::runtime_error("unable to initialize rosidl_runtime_c__String array");
-      }
-
-      for (size_t i = 0; i < cpp_string_vector.size(); ++i) {
-        if (
-          !rosidl_runtime_c__String__assign(
-            &string_array_field.data[i], cpp_string_vector[i].c_str()))
-        {
-          throw std::runtime_error("unable to assign rosidl_runtime_c__String");
-        }
+      const uint32_t size = deser.deserialize_len(1);
+      auto & sequence = *reinterpret_cast<rosidl_runtime_c__String__Sequence *>(field);
+      resize_c_sequence(
+        sequence, size, rosidl_runtime_c__String__Sequence__init,
+        rosidl_runtime_c__String__Sequence__fini);
+      for (size_t i = 0; i < size; ++i) {
+        deserialize_c_string(deser, sequence.data[i]);
       }
     }
   }
@@ -235,27 +241,21 @@ inline void deserialize_field<std::wstring>(
   void * field,
   cycdeser & deser)
 {
-  std::wstring wstr;
   if (!member->is_array_) {
-    deser >> wstr;
-    wstring_to_u16string(
-      wstr, *static_cast<rosidl_runtime_c__U16String *>(field));
+    deserialize_c_u16string(deser, *static_cast<rosidl_runtime_c__U16String *>(field));
   } else if (member->array_size_ && !member->is_upper_bound_) {
     auto array = static_cast<rosidl_runtime_c__U16String *>(field);
     for (size_t i = 0; i < member->array_size_; ++i) {
-      deser >> wstr;
-      wstring_to_u16string(wstr, array[i]);
+      deserialize_c_u16string(deser, array[i]);
     }
   } else {
-    uint32_t size;
-    deser >> size;
+    const uint32_t size = deser.deserialize_len(1);
     auto sequence = static_cast<rosidl_runtime_c__U16String__Sequence *>(field);
-    if (!rosidl_runtime_c__U16String__Sequence__init(sequence, size)) {
-      throw std::runtime_error("unable to initialize rosidl_runtime_c__U16String sequence");
-    }
+    resize_c_sequence(
+      *sequence, size, rosidl_runtime_c__U16String__Sequence__init,
+      rosidl_runtime_c__U16String__Sequence__fini);
     for (size_t i = 0; i < sequence->size; ++i) {
-      deser >> wstr;
-      wstring_to_u16string(wstr, sequence->data[i]);
+      deserialize_c_u16string(deser, sequence->data[i]);
     }
   }
 }
@@ -346,6 +346,189 @@ bool TypeSupport<MembersType>::deserializeROSmessage(
   return true;
 }
 
+template<typename MembersType>
+DeserializationPlan<MembersType>::DeserializationPlan(const MembersType * members)
+{
+  add_fields(members, 0);
+
+  for (size_t i = 0; i < fields_.size(); ) {
+    const Field & first = fields_[i];
+    Step step{i, 1, first.offset, first.size, first.align, 0};
+    if (first.size != 0) {
+      step.phases = valid_phases(i, 1);
+      while (i + step.n_fields < fields_.size() && fields_[i + step.n_fields].size != 0) {
+        uint8_t phases = step.phases & valid_phases(i, step.n_fields + 1);
+        if (phases == 0) {
+          break;
+        }
+        const Field & last = fields_[i + step.n_fields];
+        step.phases = phases;
+        step.size = last.offset + last.size - first.offset;
+        step.n_fields++;
+      }
+    }
+    steps_.push_back(step);
+    i += step.n_fields;
+  }
+}
+
+template<typename MembersType>
+void DeserializationPlan<MembersType>::add_fields(const MembersType * members, size_t offset)
+{
+  for (uint32_t i = 0; i < members->member_count_; ++i) {
+    const auto * member = members->members_ + i;
+    if (member->type_id_ == ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE &&
+      !member->is_array_)
+    {
+      add_fields(static_cast<const MembersType *>(member->members_->data), offset + member->offset_);
+      continue;
+    }
+
+    Field field{member, offset + member->offset_, nullptr, 0, 0, nullptr};
+    size_t primitive_size = 0;
+    switch (member->type_id_) {
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
+        field.deserialize = deserialize_field_as<bool>;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
+        field.deserialize = deserialize_field_as<uint8_t>;
+        primitive_size = 1;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
+        field.deserialize = deserialize_field_as<char>;
+        primitive_size = 1;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
+        field.deserialize = deserialize_field_as<float>;
+        primitive_size = 4;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
+        field.deserialize = deserialize_field_as<double>;
+        primitive_size = 8;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
+        field.deserialize = deserialize_field_as<int16_t>;
+        primitive_size = 2;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
+        field.deserialize = deserialize_field_as<uint16_t>;
+        primitive_size = 2;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
+        field.deserialize = deserialize_field_as<int32_t>;
+        primitive_size = 4;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
+        field.deserialize = deserialize_field_as<uint32_t>;
+        primitive_size = 4;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
+        field.deserialize = deserialize_field_as<int64_t>;
+        primitive_size = 8;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
+        field.deserialize = deserialize_field_as<uint64_t>;
+        primitive_size = 8;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
+        field.deserialize = deserialize_field_as<std::string>;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
+        field.deserialize = deserialize_field_as<std::wstring>;
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
+        field.deserialize = deserialize_message_array;
+        field.element_plan = std::make_unique<DeserializationPlan>(
+          static_cast<const MembersType *>(member->members_->data));
+        break;
+      default:
+        field.deserialize = deserialize_unknown;
+        break;
+    }
+    if (primitive_size != 0 && !member->is_array_) {
+      field.size = primitive_size;
+    } else if (primitive_size != 0 && member->array_size_ && !member->is_upper_bound_) {
+      field.size = primitive_size * member->array_size_;
+    }
+    field.align = primitive_size;
+    fields_.push_back(std::move(field));
+  }
+}
+
+template<typename MembersType>
+uint8_t DeserializationPlan<MembersType>::valid_phases(size_t first_field, size_t n_fields) const
+{
+  const Field & first = fields_[first_field];
+  uint8_t phases = 0;
+  for (size_t phase = 0; phase < 8; phase += first.align) {
+    size_t pos = phase;
+    bool valid = true;
+    for (size_t i = first_field; valid && i < first_field + n_fields; i++) {
+      const Field & field = fields_[i];
+      pos = align_int_(field.align, pos);
+      valid = (pos - phase == field.offset - first.offset);
+      pos += field.size;
+    }
+    if (valid) {
+      phases |= static_cast<uint8_t>(1u << phase);
+    }
+  }
+  return phases;
+}
+
+template<typename MembersType>
+template<typename T>
+void DeserializationPlan<MembersType>::deserialize_field_as(
+  const Field & field, void * data, cycdeser & deser)
+{
+  deserialize_field<T>(field.member, data, deser);
+}
+
+template<typename MembersType>
+void DeserializationPlan<MembersType>::deserialize_message_array(
+  const Field & field, void * data, cycdeser & deser)
+{
+  const MemberType * member = field.member;
+  size_t array_size;
+  if (member->array_size_ && !member->is_upper_bound_) {
+    array_size = member->array_size_;
+  } else {
+    array_size = deser.deserialize_len(1);
+    resize_field(member, data, array_size);
+  }
+  if (array_size != 0 && !member->get_function) {
+    throw std::runtime_error("unexpected error: get_function function is null");
+  }
+  for (size_t index = 0; index < array_size; ++index) {
+    field.element_plan->deserialize(deser, member->get_function(data, index));
+  }
+}
+
+template<typename MembersType>
+void DeserializationPlan<MembersType>::deserialize_unknown(const Field &, void *, cycdeser &)
+{
+  throw std::runtime_error("unknown type");
+}
+
+template<typename MembersType>
+void DeserializationPlan<MembersType>::deserialize(cycdeser & deser, void * ros_message) const
+{
+  for (const Step & step : steps_) {
+    if (step.size != 0 && !deser.swaps_bytes() &&
+      ((step.phases >> deser.aligned_phase(step.align)) & 1u))
+    {
+      deser.deserialize_bytes(static_cast<char *>(ros_message) + step.offset, step.size);
+    } else {
+      for (size_t i = step.first_field; i < step.first_field + step.n_fields; i++) {
+        const Field & field = fields_[i];
+        field.deserialize(field, static_cast<char *>(ros_message) + field.offset, deser);
+      }
+    }
+  }
+}
+
 template<typename M, typename T>
 void print_field(const M * member, cycprint & deser, T & dummy)
 {
@@ -457,17 +640,25 @@ bool TypeSupport<MembersType>::deserializeROSmessage(
     prefix(deser);
   }
 
-  if (members_->member_count_ != 0) {
-    TypeSupport::deserializeROSmessage(deser, members_, ros_message);
-  } else {
+  if (members_->member_count_ == 0) {
     uint8_t dump = 0;
     deser >> dump;
     (void)dump;
+  } else if (plan_) {
+    plan_->deserialize(deser, ros_message);
+  } else {
+    TypeSupport::deserializeROSmessage(deser, members_, ros_message);
   }
 
   return true;
 }
 
+template<typename MembersType>
+void TypeSupport<MembersType>::buildDeserializationPlan()
+{
+  plan_ = std::make_unique<const DeserializationPlan<MembersType>>(members_);
+}
+
 template<typename MembersType>
 bool TypeSupport<MembersType>::printROSmessage(
   cycprint & prt,
@@ -532,6 +723,143 @@ bool TypeSupport<MembersType>::is_type_self_contained()
 {
   return TypeSupport::is_type_self_contained(members_);
 }
+
+// CDR size of a primitive, 0 if it isn't one; it is also its alignment, up to 8
+inline size_t get_cdr_size_of_primitive(uint8_t type_id)
+{
+  switch (type_id) {
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BOOL:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_BYTE:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT8:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_CHAR:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT8:
+      return 1;
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT16:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT16:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WCHAR:
+      return 2;
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT32:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT32:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT32:
+      return 4;
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_FLOAT64:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_INT64:
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_UINT64:
+      return 8;
+    case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_LONG_DOUBLE:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+// The serialized size only ever grows with the length of a string or sequence (a longer one
+// never needs less padding after it), so the maximum is the size of a message in which every
+// string and sequence is as long as it can be.  `offset` is relative to the origin of the CDR
+// stream, i.e., just after the encapsulation header.
+template<typename MembersType>
+bool TypeSupport<MembersType>::get_max_serialized_size(
+  const MembersType * members, const rmw_cyclonedds_cpp_sequence_bounds_t * bounds,
+  size_t & offset)
+{
+  for (uint32_t idx = 0; idx < members->member_count_; ++idx) {
+    const auto & member = members->members_[idx];
+    size_t count = 1;
+    if (member.is_array_) {
+      if (member.array_size_ && !member.is_upper_bound_) {
+        count = member.array_size_;
+      } else {
+        offset = align_int_(4, offset) + 4;
+        if (member.is_upper_bound_) {
+          count = member.array_size_;
+        } else if (bounds) {
+          count = bounds->max_sequence_length;
+        } else {
+          return false;
+        }
+      }
+    }
+    if (count == 0) {
+      continue;
+    }
+
+    switch (member.type_id_) {
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING:
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_WSTRING:
+        {
+          size_t length;
+          if (member.string_upper_bound_) {
+            length = member.string_upper_bound_;
+          } else if (bounds) {
+            length = bounds->max_string_length;
+          } else {
+            return false;
+          }
+          // strings include a terminating null, wstrings are serialized as wchar_t
+          const size_t payload =
+            (member.type_id_ == ::rosidl_typesupport_introspection_cpp::ROS_TYPE_STRING) ?
+            length + 1 : length * sizeof(wchar_t);
+          // all strings but the last are followed by padding up to the next length field
+          offset = align_int_(4, offset) +
+            (count - 1) * align_int_(4, 4 + payload) + 4 + payload;
+        }
+        break;
+      case ::rosidl_typesupport_introspection_cpp::ROS_TYPE_MESSAGE:
+        {
+          auto sub_members = (const MembersType *)member.members_->data;
+          // the size of an element only depends on its offset modulo 8, so once an offset
+          // modulo 8 repeats, the elements from there on repeat with the same period
+          size_t seen_index[8], seen_offset[8];
+          bool seen[8] = {false};
+          for (size_t index = 0; index < count; ++index) {
+            const size_t phase = offset % 8;
+            if (seen[phase]) {
+              const size_t period = index - seen_index[phase];
+              const size_t periods = (count - index) / period;
+              offset += periods * (offset - seen_offset[phase]);
+              index += periods * period;
+              std::fill(std::begin(seen), std::end(seen), false);
+              if (index == count) {
+                break;
+              }
+            }
+            seen[phase] = true;
+            seen_index[phase] = index;
+            seen_offset[phase] = offset;
+            if (!get_max_serialized_size(sub_members, bounds, offset)) {
+              return false;
+            }
+          }
+        }
+        break;
+      default:
+        {
+          const size_t size = get_cdr_size_of_primitive(member.type_id_);
+          if (size == 0) {
+            throw std::runtime_error("unknown type");
+          }
+          offset = align_int_(size < 8 ? size : 8, offset) + count * size;
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+template<typename MembersType>
+bool TypeSupport<MembersType>::get_max_serialized_size(
+  const rmw_cyclonedds_cpp_sequence_bounds_t * bounds, size_t & size)
+{
+  size_t offset = 0;
+  if (members_->member_count_ == 0) {
+    // an empty message is serialized as a single byte
+    offset = 1;
+  } else if (!get_max_serialized_size(members_, bounds, offset)) {
+    return false;
+  }
+  size = 4 + offset;
+  return true;
+}
 }  // namespace rmw_cyclonedds_cpp
 
 #endif  // TYPESUPPORT_IMPL_HPP_
@@ -0,0 +1,173 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "byteswap.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BYTESWAP_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+#define BYTESWAP_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+
+using byteswap_kernel = void (*)(unsigned char *, const unsigned char *, size_t, size_t);
+
+/* Works for any element size; also handles the tails the vector kernels leave */
+void byteswap_scalar(
+  unsigned char * dst, const unsigned char * src, size_t count, size_t size)
+{
+  unsigned char tmp[16];
+  for (size_t i = 0; i < count; i++, src += size, dst += size) {
+    if (size <= sizeof(tmp)) {
+      memcpy(tmp, src, size);
+      for (size_t k = 0; k < size; k++) {
+        dst[k] = tmp[size - 1 - k];
+      }
+    } else {
+      /* dst is either src or disjoint from it */
+      for (size_t k = 0; k < size / 2; k++) {
+        const unsigned char t = src[k];
+        dst[k] = src[size - 1 - k];
+        dst[size - 1 - k] = t;
+      }
+    }
+  }
+}
+
+#if BYTESWAP_X86
+/* Byte shuffles reversing 2-, 4- and 8-byte elements in a 16-byte lane; the AVX2 shuffle works
+   on two such lanes independently, so the same pattern is simply repeated */
+alignas(32) const unsigned char shuffle_masks[3][32] = {
+  {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+    1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+  {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+  {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8},
+};
+
+const unsigned char * shuffle_mask(size_t size)
+{
+  return shuffle_masks[(size == 2) ? 0 : (size == 4) ? 1 : 2];
+}
+
+__attribute__((target("ssse3")))
+void byteswap_ssse3(unsigned char * dst, const unsigned char * src, size_t count, size_t size)
+{
+  const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(shuffle_mask(size)));
+  const size_t n = count * size;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(v, mask));
+  }
+  byteswap_scalar(dst + i, src + i, (n - i) / size, size);
+}
+
+__attribute__((target("avx2")))
+void byteswap_avx2(unsigned char * dst, const unsigned char * src, size_t count, size_t size)
+{
+  const __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i *>(shuffle_mask(size)));
+  const size_t n = count * size;
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(v0, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), _mm256_shuffle_epi8(v1, mask));
+  }
+  for (; i + 32 <= n; i += 32) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(v, mask));
+  }
+  byteswap_scalar(dst + i, src + i, (n - i) / size, size);
+}
+#endif
+
+#if BYTESWAP_NEON
+void byteswap_neon(unsigned char * dst, const unsigned char * src, size_t count, size_t size)
+{
+  const size_t n = count * size;
+  size_t i = 0;
+  switch (size) {
+    case 2:
+      for (; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, vrev16q_u8(vld1q_u8(src + i)));
+      }
+      break;
+    case 4:
+      for (; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, vrev32q_u8(vld1q_u8(src + i)));
+      }
+      break;
+    default:
+      for (; i + 16 <= n; i += 16) {
+        vst1q_u8(dst + i, vrev64q_u8(vld1q_u8(src + i)));
+      }
+      break;
+  }
+  byteswap_scalar(dst + i, src + i, (n - i) / size, size);
+}
+#endif
+
+byteswap_kernel select_kernel()
+{
+#if BYTESWAP_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return byteswap_avx2;
+  }
+  if (__builtin_cpu_supports("ssse3")) {
+    return byteswap_ssse3;
+  }
+#elif BYTESWAP_NEON
+  return byteswap_neon;
+#endif
+  return byteswap_scalar;
+}
+
+}  // namespace
+
+void byteswap_copy(void * dst, const void * src, size_t count, size_t size)
+{
+  auto d = static_cast<unsigned char *>(dst);
+  auto s = static_cast<const unsigned char *>(src);
+  switch (size) {
+    case 1:
+      if (d != s) {
+        memcpy(d, s, count);
+      }
+      break;
+    case 2:
+    case 4:
+    case 8: {
+        static const byteswap_kernel kernel = select_kernel();
+        kernel(d, s, count, size);
+      }
+      break;
+    default:
+      byteswap_scalar(d, s, count, size);
+      break;
+  }
+}
+
+}  // namespace rmw_cyclonedds_cpp
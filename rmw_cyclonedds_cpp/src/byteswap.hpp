@@ -1,4 +1,4 @@
-// Copyright 2019 ADLINK Technology
+// Copyright 2026 Open Source Robotics Foundation, Inc.
 //
 // Licensed under the Apache License, Version 2.0 (the "License");
 // you may not use this file except in compliance with the License.
@@ -11,26 +11,20 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#ifndef BYTESWAP_HPP_
+#define BYTESWAP_HPP_
 
-#ifndef U16STRING_HPP_
-#define U16STRING_HPP_
-
-#include <string>
-#include "rosidl_runtime_c/u16string_functions.h"
+#include <cstddef>
 
 namespace rmw_cyclonedds_cpp
 {
 
-void u16string_to_wstring(
-  const rosidl_runtime_c__U16String & u16str, std::wstring & wstr);
-
-bool wstring_to_u16string(
-  const std::wstring & wstr, rosidl_runtime_c__U16String & u16str);
-
-void u16string_to_wstring(const std::u16string & u16str, std::wstring & wstr);
-
-bool wstring_to_u16string(const std::wstring & wstr, std::u16string & u16str);
+/// Copy `count` elements of `size` bytes each from `src` to `dst`, reversing the byte order of
+/// every element.  `dst` may be equal to `src` to swap in place, but the two must not otherwise
+/// overlap.  Elements of 2, 4 and 8 bytes are swapped with the widest vector instructions the
+/// CPU supports, which are selected at runtime.
+void byteswap_copy(void * dst, const void * src, size_t count, size_t size);
 
 }  // namespace rmw_cyclonedds_cpp
 
-#endif  // U16STRING_HPP_
+#endif  // BYTESWAP_HPP_
@@ -0,0 +1,400 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "cdr_view.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "bytewise.hpp"
+#include "deserialization_exception.hpp"
+#include "rmw/error_handling.h"
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+size_t get_cdr_size_of_primitive(ROSIDL_TypeKind tk)
+{
+  switch (tk) {
+    case ROSIDL_TypeKind::BOOLEAN:
+    case ROSIDL_TypeKind::OCTET:
+    case ROSIDL_TypeKind::UINT8:
+    case ROSIDL_TypeKind::INT8:
+    case ROSIDL_TypeKind::CHAR:
+      return 1;
+    case ROSIDL_TypeKind::UINT16:
+    case ROSIDL_TypeKind::INT16:
+    case ROSIDL_TypeKind::WCHAR:
+      return 2;
+    case ROSIDL_TypeKind::UINT32:
+    case ROSIDL_TypeKind::INT32:
+    case ROSIDL_TypeKind::FLOAT:
+      return 4;
+    case ROSIDL_TypeKind::UINT64:
+    case ROSIDL_TypeKind::INT64:
+    case ROSIDL_TypeKind::DOUBLE:
+      return 8;
+    case ROSIDL_TypeKind::LONG_DOUBLE:
+      return 16;
+    default:
+      unreachable();
+  }
+}
+
+/* XCDR1 as written by CDRWriter aligns to at most 8 bytes */
+size_t get_cdr_alignof_primitive(ROSIDL_TypeKind tk)
+{
+  return std::min(get_cdr_size_of_primitive(tk), size_t{8});
+}
+
+size_t align(size_t position, size_t n_bytes)
+{
+  return (position + n_bytes - 1) / n_bytes * n_bytes;
+}
+
+const PrimitiveValueType bool_value_type{ROSIDL_TypeKind::BOOLEAN};
+
+const AnyValueType * element_value_type(const AnyValueType * value_type)
+{
+  switch (value_type->e_value_type()) {
+    case EValueType::ArrayValueType:
+      return static_cast<const ArrayValueType *>(value_type)->element_value_type();
+    case EValueType::SpanSequenceValueType:
+      return static_cast<const SpanSequenceValueType *>(value_type)->element_value_type();
+    case EValueType::BoolVectorValueType:
+      return &bool_value_type;
+    default:
+      throw std::invalid_argument("field is not an array or sequence");
+  }
+}
+}  // namespace
+
+CDRView::CDRView(const StructValueType & root_value_type, const void * data, size_t size)
+: m_root_value_type(root_value_type)
+{
+  auto bytes = static_cast<const unsigned char *>(data);
+  if (size < 4) {
+    throw DeserializationException("serialized data too short for the encapsulation header");
+  }
+  /* plain CDR, big- or little-endian */
+  if (bytes[0] != 0 || bytes[1] > 1) {
+    throw DeserializationException("unsupported encoding of serialized data");
+  }
+  m_swap_bytes = (bytes[1] == 1) != (native_endian() == endian::little);
+  m_origin = bytes + 4;
+  m_size = size - 4;
+}
+
+size_t CDRView::check(size_t position, size_t n_bytes) const
+{
+  if (position > m_size || n_bytes > m_size - position) {
+    throw DeserializationException("field extends beyond the end of the serialized data");
+  }
+  return position;
+}
+
+uint32_t CDRView::read_u32(size_t position) const
+{
+  uint32_t value;
+  std::memcpy(&value, m_origin + check(align(position, 4), 4), 4);
+  if (m_swap_bytes) {
+    value = ((value & 0xffu) << 24) | ((value & 0xff00u) << 8) |
+      ((value >> 8) & 0xff00u) | (value >> 24);
+  }
+  return value;
+}
+
+std::pair<size_t, size_t> CDRView::elements(
+  const AnyValueType * value_type,
+  size_t position) const
+{
+  switch (value_type->e_value_type()) {
+    case EValueType::ArrayValueType:
+      return {position, static_cast<const ArrayValueType *>(value_type)->array_size()};
+    case EValueType::SpanSequenceValueType:
+    case EValueType::BoolVectorValueType:
+      return {align(position, 4) + 4, read_u32(position)};
+    default:
+      throw std::invalid_argument("field is not an array or sequence");
+  }
+}
+
+size_t CDRView::element_position(const AnyValueType * value_type, size_t position, size_t index)
+{
+  auto contents = elements(value_type, position);
+  auto element_type = element_value_type(value_type);
+  if (contents.second == 0) {
+    return contents.first;
+  }
+  if (element_type->e_value_type() == EValueType::PrimitiveValueType) {
+    /* elements of primitive types follow each other without padding */
+    auto tk = static_cast<const PrimitiveValueType *>(element_type)->type_kind();
+    size_t n_bytes = get_cdr_size_of_primitive(tk);
+    size_t first = check(align(contents.first, get_cdr_alignof_primitive(tk)), 0);
+    check(first, contents.second * n_bytes);
+    return first + index * n_bytes;
+  }
+  /* the count comes from the data, so don't use it to size anything: each element takes at
+     least a byte, so skipping them stops at the end of the data if the count is bogus */
+  auto & positions = m_element_positions[{value_type, position}];
+  if (positions.empty()) {
+    positions.push_back(contents.first);
+  }
+  while (positions.size() <= index) {
+    positions.push_back(skip(element_type, positions.back()));
+  }
+  return positions[index];
+}
+
+size_t CDRView::member_position(const StructValueType & value_type, size_t position, size_t index)
+{
+  auto & positions = m_member_positions[{&value_type, position}];
+  if (positions.empty()) {
+    positions.push_back(position);
+  }
+  while (positions.size() <= index) {
+    positions.push_back(
+      skip(value_type.get_member(positions.size() - 1)->value_type, positions.back()));
+  }
+  return positions[index];
+}
+
+size_t CDRView::skip(const AnyValueType * value_type, size_t position)
+{
+  switch (value_type->e_value_type()) {
+    case EValueType::PrimitiveValueType: {
+        auto tk = static_cast<const PrimitiveValueType *>(value_type)->type_kind();
+        size_t n_bytes = get_cdr_size_of_primitive(tk);
+        return check(align(position, get_cdr_alignof_primitive(tk)), n_bytes) + n_bytes;
+      }
+    case EValueType::U8StringValueType:
+    case EValueType::BoolVectorValueType: {
+        size_t n_bytes = read_u32(position);
+        return check(align(position, 4) + 4, n_bytes) + n_bytes;
+      }
+    case EValueType::U16StringValueType: {
+        size_t n_bytes = read_u32(position) * sizeof(wchar_t);
+        return check(align(position, 4) + 4, n_bytes) + n_bytes;
+      }
+    case EValueType::StructValueType: {
+        auto & struct_info = *static_cast<const StructValueType *>(value_type);
+        return member_position(struct_info, position, struct_info.n_members());
+      }
+    case EValueType::ArrayValueType:
+    case EValueType::SpanSequenceValueType:
+      return element_position(value_type, position, elements(value_type, position).second);
+    default:
+      unreachable();
+  }
+}
+
+CDRView::Field CDRView::find(const char * path)
+{
+  const AnyValueType * value_type = &m_root_value_type;
+  size_t position = 0;
+  const char * p = path;
+  while (true) {
+    if (value_type->e_value_type() != EValueType::StructValueType) {
+      throw std::invalid_argument(std::string("field is not a message in ") + path);
+    }
+    auto & struct_info = *static_cast<const StructValueType *>(value_type);
+    size_t name_length = std::strcspn(p, ".[");
+    size_t index = 0;
+    while (index < struct_info.n_members() &&
+      (std::strlen(struct_info.get_member(index)->name) != name_length ||
+      std::strncmp(struct_info.get_member(index)->name, p, name_length) != 0))
+    {
+      index++;
+    }
+    if (index == struct_info.n_members()) {
+      throw std::invalid_argument(std::string("no such field: ") + path);
+    }
+    position = member_position(struct_info, position, index);
+    value_type = struct_info.get_member(index)->value_type;
+    p += name_length;
+
+    while (*p == '[') {
+      char * end;
+      unsigned long element = std::strtoul(p + 1, &end, 10);  // NOLINT
+      if (end == p + 1 || *end != ']') {
+        throw std::invalid_argument(std::string("invalid index in ") + path);
+      }
+      if (element >= elements(value_type, position).second) {
+        throw std::invalid_argument(std::string("index out of range in ") + path);
+      }
+      position = element_position(value_type, position, element);
+      value_type = element_value_type(value_type);
+      p = end + 1;
+    }
+
+    if (*p == '\0') {
+      return {value_type, position};
+    } else if (*p != '.') {
+      throw std::invalid_argument(std::string("invalid field name ") + path);
+    }
+    p++;
+  }
+}
+
+void CDRView::get_primitive(const Field & field, void * value, size_t size) const
+{
+  if (field.value_type->e_value_type() != EValueType::PrimitiveValueType) {
+    throw std::invalid_argument("field is not of a primitive type");
+  }
+  auto tk = static_cast<const PrimitiveValueType *>(field.value_type)->type_kind();
+  size_t n_bytes = get_cdr_size_of_primitive(tk);
+  if (size != n_bytes || size != field.value_type->sizeof_type()) {
+    throw std::invalid_argument("size does not match the type of the field");
+  }
+  size_t position = check(align(field.position, get_cdr_alignof_primitive(tk)), n_bytes);
+  std::memcpy(value, m_origin + position, n_bytes);
+  if (m_swap_bytes) {
+    auto bytes = static_cast<unsigned char *>(value);
+    std::reverse(bytes, bytes + n_bytes);
+  }
+}
+
+std::pair<const char *, size_t> CDRView::get_string(const Field & field) const
+{
+  if (field.value_type->e_value_type() != EValueType::U8StringValueType) {
+    throw std::invalid_argument("field is not a string");
+  }
+  size_t position = align(field.position, 4) + 4;
+  size_t n_bytes = read_u32(field.position);
+  check(position, n_bytes);
+  /* the length includes the terminating null character */
+  if (n_bytes == 0 || m_origin[position + n_bytes - 1] != '\0') {
+    throw DeserializationException("string is not null-terminated");
+  }
+  return {reinterpret_cast<const char *>(m_origin + position), n_bytes - 1};
+}
+
+size_t CDRView::get_size(const Field & field) const
+{
+  switch (field.value_type->e_value_type()) {
+    case EValueType::ArrayValueType:
+    case EValueType::SpanSequenceValueType:
+    case EValueType::BoolVectorValueType:
+      return elements(field.value_type, field.position).second;
+    case EValueType::U8StringValueType:
+      return get_string(field).second;
+    case EValueType::U16StringValueType:
+      return read_u32(field.position);
+    default:
+      throw std::invalid_argument("field is not an array, sequence or string");
+  }
+}
+
+bool CDRView::get_data(const Field & field, const void ** data, size_t * size) const
+{
+  auto contents = elements(field.value_type, field.position);
+  auto element_type = element_value_type(field.value_type);
+  if (element_type->e_value_type() != EValueType::PrimitiveValueType) {
+    throw std::invalid_argument("field is not an array or sequence of a primitive type");
+  }
+  auto tk = static_cast<const PrimitiveValueType *>(element_type)->type_kind();
+  size_t n_bytes = get_cdr_size_of_primitive(tk);
+  if (m_swap_bytes && n_bytes > 1) {
+    return false;
+  }
+  /* an empty sequence has no alignment padding */
+  size_t position =
+    (contents.second == 0) ? contents.first :
+    align(contents.first, get_cdr_alignof_primitive(tk));
+  *size = contents.second * n_bytes;
+  *data = m_origin + check(position, *size);
+  return true;
+}
+
+}  // namespace rmw_cyclonedds_cpp
+
+namespace
+{
+/* Locate the field and pass it to f, translating exceptions to return codes */
+template<typename F>
+rmw_ret_t with_field(rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, F f)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(view, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(path, RMW_RET_INVALID_ARGUMENT);
+  try {
+    return f(view->view.find(path));
+  } catch (std::invalid_argument & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return RMW_RET_INVALID_ARGUMENT;
+  } catch (rmw_cyclonedds_cpp::Exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return RMW_RET_ERROR;
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return RMW_RET_ERROR;
+  }
+}
+}  // namespace
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_primitive(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, void * value, size_t size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(value, RMW_RET_INVALID_ARGUMENT);
+  return with_field(
+    view, path, [&](const rmw_cyclonedds_cpp::CDRView::Field & field) {
+      view->view.get_primitive(field, value, size);
+      return RMW_RET_OK;
+    });
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_string(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, const char ** data,
+  size_t * length)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(data, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(length, RMW_RET_INVALID_ARGUMENT);
+  return with_field(
+    view, path, [&](const rmw_cyclonedds_cpp::CDRView::Field & field) {
+      auto str = view->view.get_string(field);
+      *data = str.first;
+      *length = str.second;
+      return RMW_RET_OK;
+    });
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_size(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, size_t * size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+  return with_field(
+    view, path, [&](const rmw_cyclonedds_cpp::CDRView::Field & field) {
+      *size = view->view.get_size(field);
+      return RMW_RET_OK;
+    });
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_cdr_view_get_data(
+  rmw_cyclonedds_cpp_cdr_view_t * view, const char * path, const void ** data,
+  size_t * size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(data, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+  return with_field(
+    view, path, [&](const rmw_cyclonedds_cpp::CDRView::Field & field) {
+      if (!view->view.get_data(field, data, size)) {
+        RMW_SET_ERROR_MSG("serialized data is not in the native byte order");
+        return RMW_RET_UNSUPPORTED;
+      }
+      return RMW_RET_OK;
+    });
+}
@@ -0,0 +1,100 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef CDR_VIEW_HPP_
+#define CDR_VIEW_HPP_
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "TypeSupport2.hpp"
+#include "dds/ddsi/ddsi_serdata.h"
+#include "rmw_cyclonedds_cpp/cdr_view.h"
+
+namespace rmw_cyclonedds_cpp
+{
+
+/// Read-only access to the fields of a message serialized in XCDR1 by CDRWriter, without
+/// deserializing it. Where the members of a struct or the elements of an array or sequence
+/// start is computed on first use and remembered, so each part of the data is walked at most
+/// once however many fields are accessed.
+///
+/// Malformed data results in a DeserializationException, an invalid path in a
+/// std::invalid_argument.
+class CDRView
+{
+public:
+  /// A field in the data: its type and the offset, relative to the origin of the CDR stream, at
+  /// which it starts before alignment
+  struct Field
+  {
+    const AnyValueType * value_type;
+    size_t position;
+  };
+
+  /// `data` and `size` cover the serialized message including the encapsulation header
+  CDRView(const StructValueType & root_value_type, const void * data, size_t size);
+
+  /// Locate a field given a path like "header.stamp.sec" or "poses[2].position.x"
+  Field find(const char * path);
+
+  /// Copy the value of a primitive field, converted to the native byte order
+  void get_primitive(const Field & field, void * value, size_t size) const;
+  /// The characters of a string field, without the terminating null character
+  std::pair<const char *, size_t> get_string(const Field & field) const;
+  /// Number of elements of an array, sequence, string or wstring
+  size_t get_size(const Field & field) const;
+  /// The serialized elements of an array or sequence of a primitive type. Returns false if
+  /// the elements are more than one byte and not in the native byte order.
+  bool get_data(const Field & field, const void ** data, size_t * size) const;
+
+private:
+  const StructValueType & m_root_value_type;
+  const unsigned char * m_origin;
+  size_t m_size;
+  bool m_swap_bytes;
+
+  /// offsets at which the first few members of a struct start, the first being that of the
+  /// struct itself
+  std::map<std::pair<const AnyValueType *, size_t>, std::vector<size_t>> m_member_positions;
+  /// same for the elements of arrays and sequences of a non-primitive type
+  std::map<std::pair<const AnyValueType *, size_t>, std::vector<size_t>> m_element_positions;
+
+  size_t check(size_t position, size_t n_bytes) const;
+  uint32_t read_u32(size_t position) const;
+  size_t skip(const AnyValueType * value_type, size_t position);
+  size_t member_position(const StructValueType & value_type, size_t position, size_t index);
+  /// Start of the contents of an array or sequence and the number of elements in it
+  std::pair<size_t, size_t> elements(const AnyValueType * value_type, size_t position) const;
+  size_t element_position(const AnyValueType * value_type, size_t position, size_t index);
+};
+
+}  // namespace rmw_cyclonedds_cpp
+
+struct rmw_cyclonedds_cpp_cdr_view_s
+{
+  rmw_cyclonedds_cpp_cdr_view_s(
+    struct ddsi_serdata * serdata, const rmw_cyclonedds_cpp::StructValueType & root_value_type,
+    const void * data, size_t size)
+  : serdata(serdata), view(root_value_type, data, size)
+  {
+  }
+
+  /* the taken sample, keeping the data alive */
+  struct ddsi_serdata * serdata;
+  rmw_cyclonedds_cpp::CDRView view;
+};
+
+#endif  // CDR_VIEW_HPP_
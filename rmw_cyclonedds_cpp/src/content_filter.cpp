@@ -0,0 +1,1026 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "content_filter.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bytewise.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+
+/* Serialized data is XCDR1, where primitives are aligned to their size up to 8 bytes, relative
+   to the start of the message following the encapsulation header */
+constexpr size_t max_align = 8;
+
+/* Parsing and evaluating recurse as deep as the expression is nested, which includes a chain of
+   ANDs or ORs, so expressions nested deeper than this are rejected rather than risking the
+   stack of whatever thread evaluates the filter */
+constexpr size_t max_nesting = 100;
+
+size_t cdr_size_of(ROSIDL_TypeKind tk)
+{
+  switch (tk) {
+    case ROSIDL_TypeKind::BOOLEAN:
+    case ROSIDL_TypeKind::OCTET:
+    case ROSIDL_TypeKind::UINT8:
+    case ROSIDL_TypeKind::INT8:
+    case ROSIDL_TypeKind::CHAR:
+      return 1;
+    case ROSIDL_TypeKind::UINT16:
+    case ROSIDL_TypeKind::INT16:
+    case ROSIDL_TypeKind::WCHAR:
+      return 2;
+    case ROSIDL_TypeKind::UINT32:
+    case ROSIDL_TypeKind::INT32:
+    case ROSIDL_TypeKind::FLOAT:
+      return 4;
+    case ROSIDL_TypeKind::UINT64:
+    case ROSIDL_TypeKind::INT64:
+    case ROSIDL_TypeKind::DOUBLE:
+      return 8;
+    case ROSIDL_TypeKind::LONG_DOUBLE:
+      return 16;
+    default:
+      unreachable();
+  }
+}
+
+/* A position in serialized data.  Without data, it can only move over values whose size
+   doesn't depend on the contents, which is how offsets are worked out in advance. */
+struct Cursor
+{
+  const unsigned char * data;
+  size_t size;
+  size_t offset;
+  bool swap;
+
+  bool align(size_t n)
+  {
+    offset = (offset + n - 1) / n * n;
+    return offset <= size;
+  }
+
+  bool advance(size_t n)
+  {
+    if (n > size - offset) {
+      return false;
+    }
+    offset += n;
+    return true;
+  }
+
+  /* Copy a primitive of n bytes to dst in native byte order */
+  bool load(void * dst, size_t n)
+  {
+    if (data == nullptr || !align(std::min(n, max_align)) || n > size - offset) {
+      return false;
+    }
+    auto out = static_cast<unsigned char *>(dst);
+    for (size_t i = 0; i < n; i++) {
+      out[i] = data[offset + (swap ? n - 1 - i : i)];
+    }
+    offset += n;
+    return true;
+  }
+
+  bool read_length(size_t & length)
+  {
+    uint32_t value;
+    if (!load(&value, sizeof(value))) {
+      return false;
+    }
+    length = value;
+    return true;
+  }
+};
+
+/* Move over `count` consecutive values of a type */
+bool skip(Cursor & c, const AnyValueType * type, size_t count)
+{
+  switch (type->e_value_type()) {
+    case EValueType::PrimitiveValueType: {
+        /* the size is a multiple of the alignment, so elements never need padding */
+        size_t size = cdr_size_of(static_cast<const PrimitiveValueType *>(type)->type_kind());
+        if (count == 0) {
+          return true;
+        }
+        if (!c.align(std::min(size, max_align)) || count > (c.size - c.offset) / size) {
+          return false;
+        }
+        c.offset += count * size;
+        return true;
+      }
+    case EValueType::U8StringValueType:
+      for (size_t i = 0; i < count; i++) {
+        size_t length;
+        if (!c.read_length(length) || !c.advance(length)) {
+          return false;
+        }
+      }
+      return true;
+    case EValueType::U16StringValueType:
+      /* written as a wchar_t for every character */
+      for (size_t i = 0; i < count; i++) {
+        size_t length;
+        if (!c.read_length(length) || !c.advance(length * sizeof(wchar_t))) {
+          return false;
+        }
+      }
+      return true;
+    case EValueType::StructValueType: {
+        auto struct_type = static_cast<const StructValueType *>(type);
+        for (size_t i = 0; i < count; i++) {
+          for (size_t j = 0; j < struct_type->n_members(); j++) {
+            if (!skip(c, struct_type->get_member(j)->value_type, 1)) {
+              return false;
+            }
+          }
+        }
+        return true;
+      }
+    case EValueType::ArrayValueType: {
+        auto array_type = static_cast<const ArrayValueType *>(type);
+        for (size_t i = 0; i < count; i++) {
+          if (!skip(c, array_type->element_value_type(), array_type->array_size())) {
+            return false;
+          }
+        }
+        return true;
+      }
+    case EValueType::SpanSequenceValueType: {
+        auto element_type = static_cast<const SpanSequenceValueType *>(type)->element_value_type();
+        for (size_t i = 0; i < count; i++) {
+          size_t length;
+          if (!c.read_length(length) || !skip(c, element_type, length)) {
+            return false;
+          }
+        }
+        return true;
+      }
+    case EValueType::BoolVectorValueType:
+      for (size_t i = 0; i < count; i++) {
+        size_t length;
+        if (!c.read_length(length) || !c.advance(length)) {
+          return false;
+        }
+      }
+      return true;
+  }
+  unreachable();
+}
+
+enum class ValueKind
+{
+  Signed,
+  Unsigned,
+  Float,
+  String,
+};
+
+struct Value
+{
+  ValueKind kind;
+  int64_t i;
+  uint64_t u;
+  double f;
+  const char * str;
+  size_t len;
+};
+
+/* One step on the way from the start of the message to a field */
+struct Step
+{
+  enum class Op
+  {
+    /* move over `count` values of `type` */
+    Skip,
+    /* move to element `count` of a sequence with elements of `type` */
+    SequenceElement,
+  };
+  Op op;
+  const AnyValueType * type;
+  size_t count;
+};
+
+bool take_step(Cursor & c, const Step & step)
+{
+  switch (step.op) {
+    case Step::Op::Skip:
+      return skip(c, step.type, step.count);
+    case Step::Op::SequenceElement: {
+        size_t length;
+        return c.read_length(length) && step.count < length && skip(c, step.type, step.count);
+      }
+  }
+  unreachable();
+}
+
+struct Operand
+{
+  bool is_field;
+  ValueKind kind;
+  /* a literal, text holding the characters of a string */
+  Value literal;
+  std::string text;
+  /* a field: the offset where the steps start, followed by the value at the end */
+  size_t offset;
+  std::vector<Step> steps;
+  const AnyValueType * field_type;
+};
+
+enum class RelOp
+{
+  EQ, NE, LT, LE, GT, GE,
+};
+
+/* The outcome of a condition, which is unknown if the data lacks a field it needs */
+enum class Truth
+{
+  False,
+  True,
+  Unknown,
+};
+
+Truth truth(bool value)
+{
+  return value ? Truth::True : Truth::False;
+}
+
+/* -1, 0 or 1, or 2 if the values are unordered because one is not a number */
+int compare(const Value & a, const Value & b)
+{
+  if (a.kind == ValueKind::String) {
+    int cmp = memcmp(a.str, b.str, std::min(a.len, b.len));
+    if (cmp == 0) {
+      return (a.len < b.len) ? -1 : (a.len > b.len);
+    }
+    return (cmp < 0) ? -1 : 1;
+  }
+  if (a.kind == ValueKind::Float || b.kind == ValueKind::Float) {
+    auto as_double = [](const Value & v) {
+        switch (v.kind) {
+          case ValueKind::Signed: return static_cast<double>(v.i);
+          case ValueKind::Unsigned: return static_cast<double>(v.u);
+          default: return v.f;
+        }
+      };
+    double x = as_double(a), y = as_double(b);
+    return (x < y) ? -1 : (x > y) ? 1 : (x == y) ? 0 : 2;
+  }
+  if (a.kind == ValueKind::Signed && b.kind == ValueKind::Signed) {
+    return (a.i < b.i) ? -1 : (a.i > b.i);
+  }
+  if (a.kind == ValueKind::Signed) {
+    return (a.i < 0) ? -1 : compare(Value{ValueKind::Unsigned, 0, uint64_t(a.i), 0, nullptr, 0}, b);
+  }
+  if (b.kind == ValueKind::Signed) {
+    return (b.i < 0) ? 1 : compare(a, Value{ValueKind::Unsigned, 0, uint64_t(b.i), 0, nullptr, 0});
+  }
+  return (a.u < b.u) ? -1 : (a.u > b.u);
+}
+
+bool holds(RelOp op, int cmp)
+{
+  if (cmp == 2) {
+    return op == RelOp::NE;
+  }
+  switch (op) {
+    case RelOp::EQ: return cmp == 0;
+    case RelOp::NE: return cmp != 0;
+    case RelOp::LT: return cmp < 0;
+    case RelOp::LE: return cmp <= 0;
+    case RelOp::GT: return cmp > 0;
+    case RelOp::GE: return cmp >= 0;
+  }
+  unreachable();
+}
+
+/* SQL LIKE: % matches any number of characters, _ exactly one */
+bool like(const char * s, size_t slen, const char * p, size_t plen)
+{
+  size_t si = 0, pi = 0;
+  size_t star = std::string::npos, star_si = 0;
+  while (si < slen) {
+    /* % first: it is a wildcard even where the string has a % */
+    if (pi < plen && p[pi] == '%') {
+      star = pi++;
+      star_si = si;
+    } else if (pi < plen && (p[pi] == '_' || p[pi] == s[si])) {
+      si++;
+      pi++;
+    } else if (star != std::string::npos) {
+      pi = star + 1;
+      si = ++star_si;
+    } else {
+      return false;
+    }
+  }
+  while (pi < plen && p[pi] == '%') {
+    pi++;
+  }
+  return pi == plen;
+}
+
+bool get_value(const Cursor & message, const Operand & operand, Value & value)
+{
+  if (!operand.is_field) {
+    value = operand.literal;
+    if (value.kind == ValueKind::String) {
+      value.str = operand.text.data();
+      value.len = operand.text.size();
+    }
+    return true;
+  }
+  Cursor c = message;
+  c.offset = operand.offset;
+  for (const auto & step : operand.steps) {
+    if (!take_step(c, step)) {
+      return false;
+    }
+  }
+  value.kind = operand.kind;
+  if (operand.field_type->e_value_type() == EValueType::U8StringValueType) {
+    size_t length;
+    if (!c.read_length(length) || length == 0 || length > c.size - c.offset) {
+      return false;
+    }
+    value.str = reinterpret_cast<const char *>(c.data + c.offset);
+    value.len = length - 1;
+    return true;
+  }
+  auto tk = static_cast<const PrimitiveValueType *>(operand.field_type)->type_kind();
+  switch (tk) {
+    case ROSIDL_TypeKind::INT8: {
+        int8_t x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.i = x;
+        return true;
+      }
+    case ROSIDL_TypeKind::INT16: {
+        int16_t x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.i = x;
+        return true;
+      }
+    case ROSIDL_TypeKind::INT32: {
+        int32_t x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.i = x;
+        return true;
+      }
+    case ROSIDL_TypeKind::INT64:
+      return c.load(&value.i, sizeof(value.i));
+    case ROSIDL_TypeKind::BOOLEAN:
+    case ROSIDL_TypeKind::OCTET:
+    case ROSIDL_TypeKind::UINT8:
+    case ROSIDL_TypeKind::CHAR: {
+        uint8_t x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.u = (tk == ROSIDL_TypeKind::BOOLEAN) ? (x != 0) : x;
+        return true;
+      }
+    case ROSIDL_TypeKind::UINT16:
+    case ROSIDL_TypeKind::WCHAR: {
+        uint16_t x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.u = x;
+        return true;
+      }
+    case ROSIDL_TypeKind::UINT32: {
+        uint32_t x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.u = x;
+        return true;
+      }
+    case ROSIDL_TypeKind::UINT64:
+      return c.load(&value.u, sizeof(value.u));
+    case ROSIDL_TypeKind::FLOAT: {
+        float x;
+        if (!c.load(&x, sizeof(x))) {return false;}
+        value.f = x;
+        return true;
+      }
+    case ROSIDL_TypeKind::DOUBLE:
+      return c.load(&value.f, sizeof(value.f));
+    default:
+      unreachable();
+  }
+}
+
+}  // namespace
+
+struct ContentFilter::Node
+{
+  enum class Kind
+  {
+    And,
+    Or,
+    Not,
+    Compare,
+    Between,
+    Like,
+  };
+  Kind kind;
+  /* operands of AND and OR, the operand of NOT in lhs */
+  std::unique_ptr<Node> lhs, rhs;
+  /* the values compared: two, or three for BETWEEN */
+  std::vector<Operand> operands;
+  RelOp rel;
+  /* NOT BETWEEN, NOT LIKE */
+  bool negate;
+  /* number of nodes on the longest path down from this one */
+  size_t height {1};
+
+  Truth evaluate(const Cursor & message) const
+  {
+    switch (kind) {
+      case Kind::And: {
+          Truth a = lhs->evaluate(message);
+          if (a == Truth::False) {
+            return a;
+          }
+          Truth b = rhs->evaluate(message);
+          return (b == Truth::True) ? a : b;
+        }
+      case Kind::Or: {
+          Truth a = lhs->evaluate(message);
+          if (a == Truth::True) {
+            return a;
+          }
+          Truth b = rhs->evaluate(message);
+          return (b == Truth::False) ? a : b;
+        }
+      case Kind::Not: {
+          Truth a = lhs->evaluate(message);
+          return (a == Truth::Unknown) ? a : truth(a == Truth::False);
+        }
+      default:
+        break;
+    }
+    Value values[3];
+    for (size_t i = 0; i < operands.size(); i++) {
+      if (!get_value(message, operands[i], values[i])) {
+        return Truth::Unknown;
+      }
+    }
+    switch (kind) {
+      case Kind::Compare:
+        return truth(holds(rel, compare(values[0], values[1])));
+      case Kind::Between:
+        return truth(
+          (holds(RelOp::GE, compare(values[0], values[1])) &&
+          holds(RelOp::LE, compare(values[0], values[2]))) != negate);
+      case Kind::Like:
+        return truth(like(values[0].str, values[0].len, values[1].str, values[1].len) != negate);
+      default:
+        unreachable();
+    }
+  }
+};
+
+namespace
+{
+
+struct Token
+{
+  enum class Kind
+  {
+    End,
+    Identifier,
+    Number,
+    String,
+    Parameter,
+    RelOp,
+    LParen,
+    RParen,
+    LBracket,
+    RBracket,
+    Dot,
+  };
+  Kind kind;
+  /* the identifier, number, string contents or parameter index */
+  std::string text;
+  RelOp rel;
+  size_t pos;
+};
+
+[[noreturn]] void fail(const std::string & what, size_t pos)
+{
+  throw std::invalid_argument(
+          "invalid content filter: " + what + " at position " + std::to_string(pos));
+}
+
+std::vector<Token> tokenize(const std::string & s)
+{
+  std::vector<Token> tokens;
+  size_t i = 0;
+  auto is_digit = [&s](size_t k) {return k < s.size() && s[k] >= '0' && s[k] <= '9';};
+  auto is_ident_char = [&s, &is_digit](size_t k) {
+      return k < s.size() && (is_digit(k) || s[k] == '_' ||
+             (s[k] >= 'a' && s[k] <= 'z') || (s[k] >= 'A' && s[k] <= 'Z'));
+    };
+  while (true) {
+    while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\n' || s[i] == '\r')) {
+      i++;
+    }
+    Token t{Token::Kind::End, "", RelOp::EQ, i};
+    if (i == s.size()) {
+      tokens.push_back(t);
+      return tokens;
+    }
+    const char c = s[i];
+    if (is_digit(i) || ((c == '-' || c == '+' || c == '.') && is_digit(i + 1)) ||
+      ((c == '-' || c == '+') && i + 2 < s.size() && s[i + 1] == '.' && is_digit(i + 2)))
+    {
+      size_t start = i++;
+      while (is_ident_char(i) || s[i] == '.' ||
+        ((s[i] == '+' || s[i] == '-') && (s[i - 1] == 'e' || s[i - 1] == 'E')))
+      {
+        i++;
+      }
+      t.kind = Token::Kind::Number;
+      t.text = s.substr(start, i - start);
+    } else if (is_ident_char(i)) {
+      size_t start = i;
+      while (is_ident_char(i)) {
+        i++;
+      }
+      t.kind = Token::Kind::Identifier;
+      t.text = s.substr(start, i - start);
+    } else if (c == '\'') {
+      /* a quote in the string is written as two quotes */
+      t.kind = Token::Kind::String;
+      while (true) {
+        if (++i == s.size()) {
+          fail("unterminated string", t.pos);
+        }
+        if (s[i] == '\'') {
+          if (i + 1 < s.size() && s[i + 1] == '\'') {
+            i++;
+          } else {
+            i++;
+            break;
+          }
+        }
+        t.text += s[i];
+      }
+    } else if (c == '%') {
+      size_t start = ++i;
+      while (is_digit(i)) {
+        i++;
+      }
+      if (i == start || i - start > 2) {
+        fail("expected a parameter number from 0 to 99 after %", t.pos);
+      }
+      t.kind = Token::Kind::Parameter;
+      t.text = s.substr(start, i - start);
+    } else if (c == '=' || c == '<' || c == '>' || c == '!') {
+      const char d = (i + 1 < s.size()) ? s[i + 1] : '\0';
+      t.kind = Token::Kind::RelOp;
+      if (c == '=') {
+        t.rel = RelOp::EQ;
+        i += (d == '=') ? 2 : 1;
+      } else if (c == '!' && d == '=') {
+        t.rel = RelOp::NE;
+        i += 2;
+      } else if (c == '<' && d == '>') {
+        t.rel = RelOp::NE;
+        i += 2;
+      } else if (c == '<') {
+        t.rel = (d == '=') ? RelOp::LE : RelOp::LT;
+        i += (d == '=') ? 2 : 1;
+      } else if (c == '>') {
+        t.rel = (d == '=') ? RelOp::GE : RelOp::GT;
+        i += (d == '=') ? 2 : 1;
+      } else {
+        fail("unexpected character '!'", t.pos);
+      }
+    } else {
+      switch (c) {
+        case '(': t.kind = Token::Kind::LParen; break;
+        case ')': t.kind = Token::Kind::RParen; break;
+        case '[': t.kind = Token::Kind::LBracket; break;
+        case ']': t.kind = Token::Kind::RBracket; break;
+        case '.': t.kind = Token::Kind::Dot; break;
+        default: fail(std::string("unexpected character '") + c + "'", t.pos);
+      }
+      i++;
+    }
+    tokens.push_back(std::move(t));
+  }
+}
+
+bool is_keyword(const Token & t, const char * keyword)
+{
+  if (t.kind != Token::Kind::Identifier || t.text.size() != strlen(keyword)) {
+    return false;
+  }
+  for (size_t i = 0; i < t.text.size(); i++) {
+    char c = t.text[i];
+    if (((c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c) != keyword[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool is_reserved(const Token & t)
+{
+  for (auto keyword : {"AND", "OR", "NOT", "BETWEEN", "LIKE", "TRUE", "FALSE"}) {
+    if (is_keyword(t, keyword)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Turn a literal token into an operand, or return false if it isn't one */
+bool make_literal(const Token & t, Operand & operand)
+{
+  operand.is_field = false;
+  operand.literal = Value{ValueKind::Unsigned, 0, 0, 0.0, nullptr, 0};
+  if (is_keyword(t, "TRUE") || is_keyword(t, "FALSE")) {
+    operand.literal.u = is_keyword(t, "TRUE");
+  } else if (t.kind == Token::Kind::String) {
+    operand.literal.kind = ValueKind::String;
+    operand.text = t.text;
+  } else if (t.kind == Token::Kind::Number) {
+    const char * str = t.text.c_str();
+    char * end;
+    errno = 0;
+    bool hex = t.text.find_first_of("xX") != std::string::npos;
+    if (!hex && t.text.find_first_of(".eE") != std::string::npos) {
+      operand.literal.kind = ValueKind::Float;
+      operand.literal.f = strtod(str, &end);
+    } else if (str[0] == '-') {
+      operand.literal.kind = ValueKind::Signed;
+      operand.literal.i = strtoll(str, &end, 0);
+    } else {
+      operand.literal.u = strtoull(str, &end, 0);
+    }
+    if (*end != '\0' || errno == ERANGE) {
+      fail("invalid number " + t.text, t.pos);
+    }
+  } else {
+    return false;
+  }
+  operand.kind = operand.literal.kind;
+  return true;
+}
+
+class Parser
+{
+public:
+  Parser(
+    const StructValueType & root, const std::string & expression,
+    const std::vector<std::string> & parameters)
+  : m_root(root), m_parameters(parameters), m_tokens(tokenize(expression))
+  {
+  }
+
+  std::unique_ptr<ContentFilter::Node> parse()
+  {
+    auto node = parse_or();
+    if (peek().kind != Token::Kind::End) {
+      fail("unexpected '" + peek().text + "'", peek().pos);
+    }
+    return node;
+  }
+
+private:
+  using Node = ContentFilter::Node;
+
+  const Token & peek() const {return m_tokens[m_next];}
+  /* the end token is returned again and again */
+  const Token & next()
+  {
+    const Token & t = m_tokens[m_next];
+    if (t.kind != Token::Kind::End) {
+      m_next++;
+    }
+    return t;
+  }
+
+  std::unique_ptr<Node> make_logical(
+    Node::Kind kind, std::unique_ptr<Node> lhs, std::unique_ptr<Node> rhs, size_t pos)
+  {
+    auto node = std::make_unique<Node>();
+    node->kind = kind;
+    node->height = 1 + std::max(lhs->height, rhs ? rhs->height : 0);
+    if (node->height > max_nesting) {
+      fail("expression nested too deeply", pos);
+    }
+    node->lhs = std::move(lhs);
+    node->rhs = std::move(rhs);
+    return node;
+  }
+
+  std::unique_ptr<Node> parse_or()
+  {
+    auto node = parse_and();
+    while (is_keyword(peek(), "OR")) {
+      size_t pos = next().pos;
+      node = make_logical(Node::Kind::Or, std::move(node), parse_and(), pos);
+    }
+    return node;
+  }
+
+  std::unique_ptr<Node> parse_and()
+  {
+    auto node = parse_not();
+    while (is_keyword(peek(), "AND")) {
+      size_t pos = next().pos;
+      node = make_logical(Node::Kind::And, std::move(node), parse_not(), pos);
+    }
+    return node;
+  }
+
+  std::unique_ptr<Node> parse_not()
+  {
+    /* NOT and parentheses recurse before there is a node to check the height of */
+    if (m_depth == max_nesting) {
+      fail("expression nested too deeply", peek().pos);
+    }
+    if (is_keyword(peek(), "NOT")) {
+      size_t pos = next().pos;
+      m_depth++;
+      auto operand = parse_not();
+      m_depth--;
+      return make_logical(Node::Kind::Not, std::move(operand), nullptr, pos);
+    }
+    if (peek().kind == Token::Kind::LParen) {
+      next();
+      m_depth++;
+      auto node = parse_or();
+      m_depth--;
+      const Token & t = next();
+      if (t.kind != Token::Kind::RParen) {
+        fail("expected ')'", t.pos);
+      }
+      return node;
+    }
+    return parse_predicate();
+  }
+
+  std::unique_ptr<Node> parse_predicate()
+  {
+    auto node = std::make_unique<Node>();
+    node->negate = false;
+    node->operands.push_back(parse_operand());
+    const Token & t = next();
+    if (t.kind == Token::Kind::RelOp) {
+      node->kind = Node::Kind::Compare;
+      node->rel = t.rel;
+      node->operands.push_back(parse_operand());
+      check_comparable(node->operands[0], node->operands[1], t.pos);
+      return node;
+    }
+    const Token * keyword = &t;
+    if (is_keyword(t, "NOT")) {
+      node->negate = true;
+      keyword = &next();
+    }
+    if (is_keyword(*keyword, "BETWEEN")) {
+      node->kind = Node::Kind::Between;
+      node->operands.push_back(parse_operand());
+      const Token & t_and = next();
+      if (!is_keyword(t_and, "AND")) {
+        fail("expected AND in BETWEEN", t_and.pos);
+      }
+      node->operands.push_back(parse_operand());
+      check_comparable(node->operands[0], node->operands[1], keyword->pos);
+      check_comparable(node->operands[0], node->operands[2], keyword->pos);
+      return node;
+    }
+    if (is_keyword(*keyword, "LIKE")) {
+      node->kind = Node::Kind::Like;
+      node->operands.push_back(parse_operand());
+      if (node->operands[0].kind != ValueKind::String ||
+        node->operands[1].kind != ValueKind::String)
+      {
+        fail("LIKE needs strings", keyword->pos);
+      }
+      return node;
+    }
+    fail("expected a comparison, BETWEEN or LIKE", keyword->pos);
+  }
+
+  static void check_comparable(const Operand & a, const Operand & b, size_t pos)
+  {
+    if ((a.kind == ValueKind::String) != (b.kind == ValueKind::String)) {
+      fail("comparing a string with a number", pos);
+    }
+  }
+
+  Operand parse_operand()
+  {
+    Operand operand;
+    const Token & t = next();
+    if (t.kind == Token::Kind::Parameter) {
+      size_t index = std::stoul(t.text);
+      if (index >= m_parameters.size()) {
+        fail("parameter %" + t.text + " not given", t.pos);
+      }
+      /* a parameter holds a single literal, written the same way as in the expression */
+      std::vector<Token> tokens;
+      try {
+        tokens = tokenize(m_parameters[index]);
+      } catch (std::invalid_argument &) {
+        tokens.clear();
+      }
+      if (tokens.size() != 2 || !make_literal(tokens[0], operand)) {
+        fail("parameter %" + t.text + " is not a literal: " + m_parameters[index], t.pos);
+      }
+      return operand;
+    }
+    if (make_literal(t, operand)) {
+      return operand;
+    }
+    if (t.kind != Token::Kind::Identifier || is_reserved(t)) {
+      fail("expected a field, literal or parameter", t.pos);
+    }
+    parse_field(t, operand);
+    return operand;
+  }
+
+  void parse_field(const Token & first, Operand & operand)
+  {
+    operand.is_field = true;
+    std::string path;
+    const AnyValueType * type = &m_root;
+    const Token * name = &first;
+    while (true) {
+      if (name != nullptr) {
+        if (type->e_value_type() != EValueType::StructValueType) {
+          fail(path + " has no members", name->pos);
+        }
+        auto struct_type = static_cast<const StructValueType *>(type);
+        size_t k = 0;
+        while (k < struct_type->n_members() && name->text != struct_type->get_member(k)->name) {
+          k++;
+        }
+        if (k == struct_type->n_members()) {
+          fail("no field " + name->text + (path.empty() ? "" : " in " + path), name->pos);
+        }
+        for (size_t j = 0; j < k; j++) {
+          operand.steps.push_back(
+            Step{Step::Op::Skip, struct_type->get_member(j)->value_type, 1});
+        }
+        type = struct_type->get_member(k)->value_type;
+        path += (path.empty() ? "" : ".") + name->text;
+        name = nullptr;
+      }
+      if (peek().kind == Token::Kind::Dot) {
+        next();
+        name = &next();
+        if (name->kind != Token::Kind::Identifier) {
+          fail("expected a field name", name->pos);
+        }
+      } else if (peek().kind == Token::Kind::LBracket) {
+        size_t pos = next().pos;
+        const Token & index_token = next();
+        Operand index;
+        if (!make_literal(index_token, index) || index.kind != ValueKind::Unsigned ||
+          next().kind != Token::Kind::RBracket)
+        {
+          fail("expected an index", pos);
+        }
+        type = index_element(type, static_cast<size_t>(index.literal.u), operand.steps, pos);
+        path += "[" + index_token.text + "]";
+      } else {
+        break;
+      }
+    }
+
+    switch (type->e_value_type()) {
+      case EValueType::U8StringValueType:
+        operand.kind = ValueKind::String;
+        break;
+      case EValueType::PrimitiveValueType:
+        switch (static_cast<const PrimitiveValueType *>(type)->type_kind()) {
+          case ROSIDL_TypeKind::FLOAT:
+          case ROSIDL_TypeKind::DOUBLE:
+            operand.kind = ValueKind::Float;
+            break;
+          case ROSIDL_TypeKind::LONG_DOUBLE:
+            fail(path + " is a long double, which filters don't support", first.pos);
+          case ROSIDL_TypeKind::INT8:
+          case ROSIDL_TypeKind::INT16:
+          case ROSIDL_TypeKind::INT32:
+          case ROSIDL_TypeKind::INT64:
+            operand.kind = ValueKind::Signed;
+            break;
+          default:
+            operand.kind = ValueKind::Unsigned;
+            break;
+        }
+        break;
+      case EValueType::U16StringValueType:
+        /* the characters would have to be converted to compare them with a string literal */
+        fail(path + " is a wstring, which filters don't support", first.pos);
+      default:
+        fail(path + " is not a number or a string", first.pos);
+    }
+    operand.field_type = type;
+
+    /* as far as the sizes of the values in between don't depend on the contents, the offset of
+       the field is known up front and only the remaining steps are taken for every message */
+    Cursor c{nullptr, std::numeric_limits<size_t>::max(), 0, false};
+    size_t folded = 0;
+    while (folded < operand.steps.size()) {
+      Cursor tentative = c;
+      if (!take_step(tentative, operand.steps[folded])) {
+        break;
+      }
+      c = tentative;
+      folded++;
+    }
+    operand.offset = c.offset;
+    operand.steps.erase(operand.steps.begin(), operand.steps.begin() + folded);
+  }
+
+  static const AnyValueType * index_element(
+    const AnyValueType * type, size_t index, std::vector<Step> & steps, size_t pos)
+  {
+    switch (type->e_value_type()) {
+      case EValueType::ArrayValueType: {
+          auto array_type = static_cast<const ArrayValueType *>(type);
+          if (index >= array_type->array_size()) {
+            fail("index out of range", pos);
+          }
+          steps.push_back(Step{Step::Op::Skip, array_type->element_value_type(), index});
+          return array_type->element_value_type();
+        }
+      case EValueType::SpanSequenceValueType: {
+          auto element_type =
+            static_cast<const SpanSequenceValueType *>(type)->element_value_type();
+          steps.push_back(Step{Step::Op::SequenceElement, element_type, index});
+          return element_type;
+        }
+      case EValueType::BoolVectorValueType: {
+          static const PrimitiveValueType element_type(ROSIDL_TypeKind::BOOLEAN);
+          steps.push_back(Step{Step::Op::SequenceElement, &element_type, index});
+          return &element_type;
+        }
+      default:
+        fail("indexing something that is not an array or sequence", pos);
+    }
+  }
+
+  const StructValueType & m_root;
+  const std::vector<std::string> & m_parameters;
+  std::vector<Token> m_tokens;
+  size_t m_next {0};
+  /* NOTs and parentheses parse_not is currently inside of */
+  size_t m_depth {0};
+};
+
+}  // namespace
+
+ContentFilter::ContentFilter(
+  const StructValueType & value_type, const std::string & expression,
+  const std::vector<std::string> & parameters)
+: m_expression(expression), m_parameters(parameters)
+{
+  m_root = Parser(value_type, expression, parameters).parse();
+}
+
+ContentFilter::~ContentFilter() = default;
+
+bool ContentFilter::accepts(const void * serialized, size_t size) const
+{
+  auto header = static_cast<const unsigned char *>(serialized);
+  /* plain CDR in either byte order is all this handles */
+  if (size < 4 || header[0] != 0 || header[1] > 1) {
+    return true;
+  }
+  bool little = header[1] == 1;
+  Cursor message{header + 4, size - 4, 0, little != (native_endian() == endian::little)};
+  return m_root->evaluate(message) == Truth::True;
+}
+
+}  // namespace rmw_cyclonedds_cpp
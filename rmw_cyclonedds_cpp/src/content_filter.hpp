@@ -0,0 +1,67 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef CONTENT_FILTER_HPP_
+#define CONTENT_FILTER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TypeSupport2.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+/// A content filter, compiled from a filter expression in the subset of DDS SQL that content
+/// filtered topics use, for evaluating it on serialized messages of a type without
+/// deserializing them.
+///
+/// The expression combines comparisons (=, <>, <, <=, >, >=), BETWEEN and LIKE with AND, OR
+/// and NOT.  Operands are fields, e.g., `header.frame_id` or `data[2]`, literals, i.e.,
+/// numbers, strings in single quotes, TRUE and FALSE, and parameters %0 .. %99, which are
+/// replaced by the literal in the parameter with that index.  Fields must be numbers or
+/// strings: wstrings, long doubles and compound values can't be compared.  Expressions nested
+/// more than 100 deep, in parentheses and NOTs or in a chain of ANDs and ORs, are rejected.
+class ContentFilter
+{
+public:
+  /// Compile the filter for messages of `value_type`, throws std::invalid_argument if the
+  /// expression is invalid or doesn't fit the type
+  ContentFilter(
+    const StructValueType & value_type, const std::string & expression,
+    const std::vector<std::string> & parameters);
+  ~ContentFilter();
+  ContentFilter(const ContentFilter &) = delete;
+  ContentFilter & operator=(const ContentFilter &) = delete;
+
+  /// Evaluate the filter on serialized data: the encapsulation header followed by the message.
+  /// Data that doesn't hold the fields the filter needs is rejected, data in an encoding it
+  /// doesn't know is accepted, leaving it to deserializing to decide.
+  bool accepts(const void * serialized, size_t size) const;
+
+  const std::string & expression() const {return m_expression;}
+  const std::vector<std::string> & parameters() const {return m_parameters;}
+
+  struct Node;
+
+private:
+  std::string m_expression;
+  std::vector<std::string> m_parameters;
+  std::unique_ptr<Node> m_root;
+};
+
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // CONTENT_FILTER_HPP_
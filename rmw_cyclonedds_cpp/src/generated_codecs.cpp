@@ -0,0 +1,119 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "generated_codecs.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <stdexcept>
+#include <string>
+
+#include "rcpputils/shared_library.hpp"
+#include "rcutils/error_handling.h"
+#include "rcutils/logging_macros.h"
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+/* The codec libraries are never unloaded: sertypes may still refer to their codecs while the
+   process is exiting, so the registry is deliberately leaked rather than destroyed. */
+struct CodecRegistry
+{
+  std::mutex lock;
+  /* nullptr for packages without a codec library, so that it is looked for only once */
+  std::map<std::string, std::unique_ptr<rcpputils::SharedLibrary>> libraries;
+  std::map<const rosidl_typesupport_introspection_cpp::MessageMembers *,
+    const GeneratedCodec *> codecs;
+};
+
+CodecRegistry & get_registry()
+{
+  static CodecRegistry * registry = new CodecRegistry;
+  return *registry;
+}
+
+rcpputils::SharedLibrary * get_codec_library(CodecRegistry & registry, const std::string & package)
+{
+  auto it = registry.libraries.find(package);
+  if (it != registry.libraries.end()) {
+    return it->second.get();
+  }
+  std::unique_ptr<rcpputils::SharedLibrary> library;
+  try {
+    library = std::make_unique<rcpputils::SharedLibrary>(
+      rcpputils::get_platform_library_name(package + "__rmw_cyclonedds_cpp"));
+  } catch (const std::exception &) {
+    /* most packages don't have one, that's fine */
+    rcutils_reset_error();
+  }
+  return registry.libraries.emplace(package, std::move(library)).first->second.get();
+}
+
+const GeneratedCodec * load_generated_codec(
+  CodecRegistry & registry,
+  const rosidl_typesupport_introspection_cpp::MessageMembers * members)
+{
+  const std::string message_namespace(members->message_namespace_);
+  const std::string package = message_namespace.substr(0, message_namespace.find("::"));
+  if (package.empty()) {
+    return nullptr;
+  }
+  rcpputils::SharedLibrary * library = get_codec_library(registry, package);
+  const std::string symbol = "rmw_cyclonedds_cpp__get_generated_codec__" +
+    std::regex_replace(message_namespace, std::regex("::"), "__") + "__" +
+    members->message_name_;
+  if (library == nullptr || !library->has_symbol(symbol)) {
+    return nullptr;
+  }
+  auto get_codec = reinterpret_cast<const GeneratedCodec * (*)()>(library->get_symbol(symbol));
+  const GeneratedCodec * codec = get_codec();
+  if (codec->version != RMW_CYCLONEDDS_CPP_GENERATED_CODEC_VERSION ||
+    codec->sizeof_message != members->size_of_)
+  {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_cyclonedds_cpp",
+      "ignoring generated codec for %s::%s in %s: it does not match this build, "
+      "rebuild %s", message_namespace.c_str(), members->message_name_,
+      library->get_library_path().c_str(), package.c_str());
+    return nullptr;
+  }
+  return codec;
+}
+}  // namespace
+
+const GeneratedCodec * find_generated_codec(
+  const rosidl_typesupport_introspection_cpp::MessageMembers * members)
+{
+  CodecRegistry & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.lock);
+  auto it = registry.codecs.find(members);
+  if (it != registry.codecs.end()) {
+    return it->second;
+  }
+  const GeneratedCodec * codec = nullptr;
+  try {
+    codec = load_generated_codec(registry, members);
+  } catch (const std::exception & e) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_cyclonedds_cpp", "failed to load generated codec for %s::%s: %s",
+      members->message_namespace_, members->message_name_, e.what());
+  }
+  registry.codecs.emplace(members, codec);
+  return codec;
+}
+
+}  // namespace rmw_cyclonedds_cpp
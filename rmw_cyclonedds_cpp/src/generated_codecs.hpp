@@ -0,0 +1,30 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef GENERATED_CODECS_HPP_
+#define GENERATED_CODECS_HPP_
+
+#include "rmw_cyclonedds_cpp/generated_codec.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+/// Return the codec generated by rmw_cyclonedds_cpp_generate_codecs() for this message type,
+/// loading the codec library of its package on first use, or nullptr if there is none.
+const GeneratedCodec * find_generated_codec(
+  const rosidl_typesupport_introspection_cpp::MessageMembers * members);
+
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // GENERATED_CODECS_HPP_
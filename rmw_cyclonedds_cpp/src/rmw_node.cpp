@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <cassert>
+#include <cctype>
 #include <cstring>
 #include <mutex>
 #include <unordered_map>
@@ -23,6 +24,7 @@
 #include <map>
 #include <set>
 #include <functional>
+#include <array>
 #include <atomic>
 #include <memory>
 #include <vector>
@@ -88,6 +90,14 @@
 #include "dds/ddsc/dds_loan_api.h"
 #include "serdes.hpp"
 #include "serdata.hpp"
+#include "serialization_cache.hpp"
+#include "type_registry.hpp"
+#include "worker_pool.hpp"
+#include "cdr_view.hpp"
+#include "content_filter.hpp"
+#include "rmw_cyclonedds_cpp/parallel_take.h"
+#include "rmw_cyclonedds_cpp/sequence_bounds.h"
+#include "rmw_cyclonedds_cpp/take_sequence.h"
 #include "demangle.hpp"
 
 using namespace std::literals::chrono_literals;
@@ -182,6 +192,7 @@ static rmw_ret_t destroy_guard_condition(rmw_guard_condition_t * gc);
 
 struct CddsDomain;
 struct CddsWaitset;
+struct MatchedReaderFilters;
 
 struct Cdds
 {
@@ -200,8 +211,16 @@ struct Cdds
      deleted */
   std::unordered_set<CddsWaitset *> waitsets;
 
+  /* set once a reader advertising a content filter has been seen, see matched_reader_filters */
+  std::atomic<bool> have_reader_filters;
+
+  /* the reader filters of all publishers that may skip samples, which discovery invalidates
+     whenever a reader appears, changes or disappears, protected by reader_filters_lock */
+  std::mutex reader_filters_lock;
+  std::unordered_set<MatchedReaderFilters *> reader_filters;
+
   Cdds()
-  : gc_for_empty_waitset(0)
+  : gc_for_empty_waitset(0), have_reader_filters(false)
   {}
 };
 
@@ -347,8 +366,12 @@ struct user_callback_data_t
   rmw_event_callback_t event_callback[DDS_STATUS_ID_MAX + 1] {nullptr};
   const void * event_data[DDS_STATUS_ID_MAX + 1] {nullptr};
   size_t event_unread_count[DDS_STATUS_ID_MAX + 1] {0};
+  /* of a publisher that may skip samples, invalidated when the matched readers change */
+  MatchedReaderFilters * reader_filters {nullptr};
 };
 
+struct PublisherLoanPool;
+
 struct CddsPublisher : CddsEntity
 {
   dds_instance_handle_t pubiid;
@@ -358,9 +381,215 @@ struct CddsPublisher : CddsEntity
   dds_data_allocator_t data_allocator;
   uint32_t sample_size;
   bool is_loaning_available;
+  /* messages loaned out when they can't be loaned from shared memory */
+  std::unique_ptr<PublisherLoanPool> loan_pool;
+  /* content filters of the matched readers, only for publishers that may skip samples */
+  std::unique_ptr<MatchedReaderFilters> reader_filters;
+  /* publish large arrays by reference, see publish_by_reference */
+  bool publish_by_reference;
   user_callback_data_t user_callback_data;
 };
 
+/* Backs rmw_publisher_allocation_t: a ring of serdata with payload buffers allocated up front
+   for the largest message allowed by the bounds, so that rmw_publish need not allocate.  A
+   serdata can be reused once DDSI no longer references it, i.e., once the writer history cache
+   has dropped it.  The type support is all rmw_init_publisher_allocation gets, so a serdata is
+   only tied to the sertype of a publisher when it is used. */
+struct CddsPublisherAllocation
+{
+  /* enough for the history of a typical reliable, keep-last writer */
+  static constexpr size_t ring_size = 16;
+
+  explicit CddsPublisherAllocation(size_t payload_capacity)
+  {
+    for (auto & d : ring) {
+      d = new serdata_rmw();
+      d->reserve(payload_capacity);
+    }
+  }
+
+  ~CddsPublisherAllocation()
+  {
+    for (auto d : ring) {
+      if (d->ops != nullptr) {
+        /* freed by DDSI if it is still in use */
+        ddsi_serdata_unref(d);
+      } else {
+        delete d;
+      }
+    }
+  }
+
+  /* Serialize a sample into the next free serdata and return it with a reference for the
+     caller, or return nullptr if all of them are in use */
+  struct ddsi_serdata * serialize(const struct ddsi_sertype * type, const void * sample)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < ring_size; i++) {
+      serdata_rmw * d = ring[(next + i) % ring_size];
+      if (d->ops == nullptr || ddsrt_atomic_ld32(&d->refc) == 1) {
+        next = (next + i + 1) % ring_size;
+        serdata_rmw_reuse_from_sample(d, type, sample);
+        return ddsi_serdata_ref(d);
+      }
+    }
+    return nullptr;
+  }
+
+  std::mutex mutex;
+  std::array<serdata_rmw *, ring_size> ring;
+  size_t next {0};
+};
+
+/* Messages for loaning out by a publisher without shared memory: initialized messages owned by
+   the publisher that are serialized into a ring of serdata when published and then handed out
+   again, so that once there are as many as the application uses at the same time, neither
+   borrowing nor publishing allocates.  A recycled message keeps its contents, and therefore
+   also the memory of its sequences and strings. */
+struct PublisherLoanPool
+{
+  /* messages kept for reuse, more than that are freed when they come back */
+  static constexpr size_t max_free = 8;
+
+  PublisherLoanPool(const rosidl_message_type_support_t & type_supports, size_t sample_size)
+  : type_supports(type_supports), sample_size(sample_size)
+  {
+    free.reserve(max_free);
+  }
+
+  ~PublisherLoanPool()
+  {
+    /* also the ones the application never gave back */
+    for (void * message : messages) {
+      destroy_message(message);
+    }
+  }
+
+  PublisherLoanPool(const PublisherLoanPool &) = delete;
+  PublisherLoanPool & operator=(const PublisherLoanPool &) = delete;
+
+  void * borrow()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free.empty()) {
+      void * message = ::operator new(sample_size);
+      try {
+        rmw_cyclonedds_cpp::init_message(&type_supports, message);
+      } catch (...) {
+        ::operator delete(message);
+        throw;
+      }
+      messages.insert(message);
+      return message;
+    }
+    void * message = free.back();
+    free.pop_back();
+    return message;
+  }
+
+  /* Take a message back, returns false if it isn't one of ours */
+  bool give_back(void * message)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = messages.find(message);
+    if (it == messages.end()) {
+      return false;
+    }
+    if (free.size() < max_free) {
+      free.push_back(message);
+    } else {
+      messages.erase(it);
+      destroy_message(message);
+    }
+    return true;
+  }
+
+  /* Serialize a loaned message into one of the serdata of the pool, see
+     CddsPublisherAllocation::serialize */
+  struct ddsi_serdata * serialize(const struct ddsi_sertype * type, const void * message)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!serdatas) {
+        serdatas = std::make_unique<CddsPublisherAllocation>(0);
+      }
+    }
+    return serdatas->serialize(type, message);
+  }
+
+  void destroy_message(void * message)
+  {
+    rmw_cyclonedds_cpp::fini_message(&type_supports, message);
+    ::operator delete(message);
+  }
+
+  const rosidl_message_type_support_t type_supports;
+  const size_t sample_size;
+  std::mutex mutex;
+  /* all messages of the pool, loaned out or not */
+  std::unordered_set<void *> messages;
+  std::vector<void *> free;
+  /* created when the first loaned message is published */
+  std::unique_ptr<CddsPublisherAllocation> serdatas;
+};
+
+using ReaderFilterSet = std::vector<std::shared_ptr<const rmw_cyclonedds_cpp::ContentFilter>>;
+
+/* The content filters the readers matched with a publisher advertise, for skipping samples that
+   none of them would accept rather than sending them only for the readers to drop them.  The
+   publication matched listener of the writer and discovery mark them stale when the matched
+   readers or their QoS may have changed, and the next publish looks at the readers again. */
+struct MatchedReaderFilters
+{
+  enum Status : uint32_t
+  {
+    Stale = 1,
+    /* there are filters, i.e., all matched readers have one */
+    Filtered = 2
+  };
+  /* 0 if no filtered readers are matched, which is all publishing needs to know then */
+  std::atomic<uint32_t> status {0};
+  std::mutex lock;
+  /* null if a matched reader takes everything */
+  std::shared_ptr<const ReaderFilterSet> filters;
+  /* compiled filters by advertised filter, so that readers with the same filter share one */
+  std::map<std::string, std::shared_ptr<const rmw_cyclonedds_cpp::ContentFilter>> compiled;
+
+  MatchedReaderFilters()
+  {
+    std::lock_guard<std::mutex> guard(gcdds().reader_filters_lock);
+    gcdds().reader_filters.insert(this);
+  }
+
+  ~MatchedReaderFilters()
+  {
+    std::lock_guard<std::mutex> guard(gcdds().reader_filters_lock);
+    gcdds().reader_filters.erase(this);
+  }
+
+  void invalidate()
+  {
+    status.fetch_or(Stale);
+  }
+};
+
+/* Scratch space for rmw_take_sequence.  It only ever grows, so once it has the size of the
+   largest batch taking does not allocate. */
+struct TakeSequenceScratch
+{
+  void reserve(size_t count)
+  {
+    if (infos.size() < count) {
+      infos.resize(count);
+      serdatas.resize(count);
+    }
+  }
+
+  std::vector<dds_sample_info_t> infos;
+  /* for taking the serialized data first and deserializing it in parallel */
+  std::vector<struct ddsi_serdata *> serdatas;
+};
+
 struct CddsSubscription : CddsEntity
 {
   rmw_gid_t gid;
@@ -369,6 +598,53 @@ struct CddsSubscription : CddsEntity
   dds_data_allocator_t data_allocator;
   bool is_loaning_available;
   user_callback_data_t user_callback_data;
+  /* scratch space for rmw_take_sequence without a subscription allocation */
+  std::mutex take_seq_lock;
+  TakeSequenceScratch take_seq_scratch;
+  /* see rmw_cyclonedds_cpp_set_parallel_take, 0 if disabled */
+  std::atomic<size_t> parallel_take_min_size {0};
+  /* messages of a memcpy-serialized type can be loaned out as the received data itself if
+     enabled with RMW_CYCLONEDDS_LOAN_RECEIVED_MESSAGES, see take_serdata_loan */
+  bool serdata_loaning_available {false};
+  /* outstanding loans of received data: the message and the serdata holding it, or a null
+     pointer if the message is a copy that had to be allocated.  There are only ever a few, and
+     the vector keeps its capacity, so that taking and returning loans doesn't allocate. */
+  std::mutex loans_lock;
+  std::vector<std::pair<const void *, struct ddsi_serdata *>> loans;
+  /* the topic of the reader, on which Cyclone evaluates the content filter */
+  dds_entity_t topic {0};
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> registered_type;
+  /* see rmw_subscription_set_content_filter: only accessed atomically because it is evaluated
+     while it may be replaced; the lock serializes replacing it */
+  std::mutex content_filter_lock;
+  std::shared_ptr<const rmw_cyclonedds_cpp::ContentFilter> content_filter;
+
+  ~CddsSubscription()
+  {
+    /* loans the application never returned */
+    for (auto & loan : loans) {
+      if (loan.second != nullptr) {
+        ddsi_serdata_unref(loan.second);
+      } else {
+        ::operator delete(const_cast<void *>(loan.first));
+      }
+    }
+  }
+};
+
+/* Backs rmw_subscription_allocation_t: the scratch space rmw_take_sequence needs, so that
+   taking does not allocate.  It is sized for a typical batch up front; a larger batch grows it
+   once, after which it keeps its size. */
+struct CddsSubscriptionAllocation
+{
+  static constexpr size_t initial_capacity = 32;
+
+  CddsSubscriptionAllocation()
+  {
+    scratch.reserve(initial_capacity);
+  }
+
+  TakeSequenceScratch scratch;
 };
 
 struct client_service_id_t
@@ -519,7 +795,26 @@ MAKE_DDS_EVENT_CALLBACK_FN(offered_incompatible_qos, OFFERED_INCOMPATIBLE_QOS)
 MAKE_DDS_EVENT_CALLBACK_FN(liveliness_changed, LIVELINESS_CHANGED)
 MAKE_DDS_EVENT_CALLBACK_FN(inconsistent_topic, INCONSISTENT_TOPIC)
 MAKE_DDS_EVENT_CALLBACK_FN(subscription_matched, SUBSCRIPTION_MATCHED)
-MAKE_DDS_EVENT_CALLBACK_FN(publication_matched, PUBLICATION_MATCHED)
+
+static void on_publication_matched_fn(
+  dds_entity_t entity,
+  const dds_publication_matched_status_t status,
+  void * arg)
+{
+  (void)status;
+  (void)entity;
+  auto data = static_cast<user_callback_data_t *>(arg);
+  std::lock_guard<std::mutex> guard(data->mutex);
+  if (data->reader_filters) {
+    data->reader_filters->invalidate();
+  }
+  auto cb = data->event_callback[DDS_PUBLICATION_MATCHED_STATUS_ID];
+  if (cb) {
+    cb(data->event_data[DDS_PUBLICATION_MATCHED_STATUS_ID], 1);
+  } else {
+    data->event_unread_count[DDS_PUBLICATION_MATCHED_STATUS_ID]++;
+  }
+}
 
 static void listener_set_event_callbacks(dds_listener_t * l, void * arg)
 {
@@ -888,6 +1183,83 @@ static bool get_user_data_key(const dds_qos_t * qos, const std::string key, std:
   return false;
 }
 
+/* A subscription advertises its content filter in the USER_DATA of its reader as
+   "filter=EXPRESSION;filterparams=P0,P1,...,;", with the characters that would get in the way
+   escaped as %XX */
+static std::string escape_user_data_value(const std::string & value)
+{
+  static const char hex[] = "0123456789abcdef";
+  std::string escaped;
+  for (char c : value) {
+    if (c == ';' || c == ',' || c == '%' || c == '=' || !isprint(static_cast<unsigned char>(c))) {
+      escaped += '%';
+      escaped += hex[static_cast<unsigned char>(c) >> 4];
+      escaped += hex[static_cast<unsigned char>(c) & 0xf];
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+static bool unescape_user_data_value(const std::string & escaped, std::string & value)
+{
+  value.clear();
+  for (size_t i = 0; i < escaped.size(); i++) {
+    if (escaped[i] != '%') {
+      value += escaped[i];
+    } else if (i + 2 < escaped.size() && isxdigit(static_cast<unsigned char>(escaped[i + 1])) &&
+      isxdigit(static_cast<unsigned char>(escaped[i + 2])))
+    {
+      value += static_cast<char>(std::stoi(escaped.substr(i + 1, 2), nullptr, 16));
+      i += 2;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static std::string content_filter_user_data(const rmw_cyclonedds_cpp::ContentFilter & filter)
+{
+  std::string user_data = "filter=" + escape_user_data_value(filter.expression()) +
+    ";filterparams=";
+  for (const auto & param : filter.parameters()) {
+    user_data += escape_user_data_value(param) + ",";
+  }
+  return user_data + ";";
+}
+
+/* Get the content filter advertised in USER_DATA, returns false if there is none; key
+   identifies the filter, i.e., it is the same for readers with the same filter */
+static bool get_user_data_content_filter(
+  const dds_qos_t * qos, std::string & key, std::string & expression,
+  std::vector<std::string> & params)
+{
+  auto map = parse_user_data(qos);
+  auto filter = map.find("filter");
+  auto filter_params = map.find("filterparams");
+  if (filter == map.end() || filter_params == map.end()) {
+    return false;
+  }
+  std::string escaped_expression(filter->second.begin(), filter->second.end());
+  std::string escaped_params(filter_params->second.begin(), filter_params->second.end());
+  if (!unescape_user_data_value(escaped_expression, expression)) {
+    return false;
+  }
+  params.clear();
+  size_t pos = 0, comma;
+  while ((comma = escaped_params.find(',', pos)) != std::string::npos) {
+    params.emplace_back();
+    if (!unescape_user_data_value(escaped_params.substr(pos, comma - pos), params.back())) {
+      return false;
+    }
+    pos = comma + 1;
+  }
+  key = escaped_expression + ";" + escaped_params;
+  return true;
+}
+
 static void handle_ParticipantEntitiesInfo(dds_entity_t reader, void * arg)
 {
   static_cast<void>(reader);
@@ -966,6 +1338,20 @@ static void handle_builtintopic_endpoint(
         ppgid,
         qos_profile,
         is_reader);
+
+      std::string filter;
+      if (is_reader && get_user_data_key(s->qos, "filter", filter)) {
+        gcdds().have_reader_filters.store(true);
+      }
+    }
+    if (is_reader && gcdds().have_reader_filters.load()) {
+      /* a reader matched with a publisher may have changed its filter, which doesn't change
+         the matched readers, so publishers check their readers before publishing the next
+         sample, see matched_reader_filters */
+      std::lock_guard<std::mutex> lock(gcdds().reader_filters_lock);
+      for (auto rf : gcdds().reader_filters) {
+        rf->invalidate();
+      }
     }
     dds_return_loan(reader, &raw, 1);
   }
@@ -1718,21 +2104,56 @@ extern "C" const rmw_guard_condition_t * rmw_node_get_graph_guard_condition(cons
 ///////////                                                                   ///////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
-using MessageTypeSupport_c =
-  rmw_cyclonedds_cpp::MessageTypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
-using MessageTypeSupport_cpp =
-  rmw_cyclonedds_cpp::MessageTypeSupport<rosidl_typesupport_introspection_cpp::MessageMembers>;
+/* Resolve message bounds passed to the RMW to those of rmw_cyclonedds_cpp, which is the same
+   lookup as for a type support handle.  Null bounds give null; false if the bounds are not from
+   this implementation.  See rmw_cyclonedds_cpp/sequence_bounds.h. */
+static bool get_sequence_bounds(
+  const rosidl_runtime_c__Sequence__bound * message_bounds,
+  const rmw_cyclonedds_cpp_sequence_bounds_t ** bounds)
+{
+  *bounds = nullptr;
+  if (message_bounds == nullptr) {
+    return true;
+  }
+  const char * identifier = RMW_CYCLONEDDS_CPP_SEQUENCE_BOUNDS_IDENTIFIER;
+  const rosidl_runtime_c__Sequence__bound * handle = message_bounds;
+  if (strcmp(handle->typesupport_identifier, identifier) != 0) {
+    handle = handle->func ? handle->func(handle, identifier) : nullptr;
+  }
+  if (handle == nullptr || handle->data == nullptr) {
+    return false;
+  }
+  *bounds = static_cast<const rmw_cyclonedds_cpp_sequence_bounds_t *>(handle->data);
+  return true;
+}
 
 extern "C" rmw_ret_t rmw_get_serialized_message_size(
   const rosidl_message_type_support_t * type_support,
   const rosidl_runtime_c__Sequence__bound * message_bounds, size_t * size)
 {
-  static_cast<void>(type_support);
-  static_cast<void>(message_bounds);
-  static_cast<void>(size);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
 
-  RMW_SET_ERROR_MSG("rmw_get_serialized_message_size: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  const rmw_cyclonedds_cpp_sequence_bounds_t * bounds;
+  if (!get_sequence_bounds(message_bounds, &bounds)) {
+    RMW_SET_ERROR_MSG(
+      "rmw_get_serialized_message_size: message bounds not from this implementation");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  try {
+    auto cached = rmw_cyclonedds_cpp::get_serialization_cache_entry(type_support);
+    if (!cached->get_max_serialized_size(bounds, *size)) {
+      RMW_SET_ERROR_MSG(
+        "rmw_get_serialized_message_size: message has unbounded strings or sequences, "
+        "message bounds are required");
+      return RMW_RET_ERROR;
+    }
+    return RMW_RET_OK;
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_get_serialized_message_size: %s", e.what());
+    return RMW_RET_ERROR;
+  }
 }
 
 extern "C" rmw_ret_t rmw_serialize(
@@ -1741,8 +2162,8 @@ extern "C" rmw_ret_t rmw_serialize(
   rmw_serialized_message_t * serialized_message)
 {
   try {
-    auto writer = rmw_cyclonedds_cpp::make_cdr_writer(
-      rmw_cyclonedds_cpp::make_message_value_type(type_support));
+    auto cached = rmw_cyclonedds_cpp::get_serialization_cache_entry(type_support);
+    const rmw_cyclonedds_cpp::BaseCDRWriter * writer = cached->writer.get();
 
     auto size = writer->get_serialized_size(ros_message);
     rmw_ret_t ret = rmw_serialized_message_resize(serialized_message, size);
@@ -1766,35 +2187,14 @@ extern "C" rmw_ret_t rmw_deserialize(
 {
   bool ok;
   try {
+    auto cached = rmw_cyclonedds_cpp::get_serialization_cache_entry(type_support);
     cycdeser sd(serialized_message->buffer, serialized_message->buffer_length);
-    const rosidl_message_type_support_t * ts;
-    if ((ts =
-      get_message_typesupport_handle(
-        type_support, rosidl_typesupport_introspection_c__identifier)) != nullptr)
-    {
-      auto members =
-        static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(ts->data);
-      MessageTypeSupport_c msgts(members);
-      ok = msgts.deserializeROSmessage(sd, ros_message, nullptr);
-    } else {
-      if ((ts =
-        get_message_typesupport_handle(
-          type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier)) != nullptr)
-      {
-        auto members =
-          static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(ts->data);
-        MessageTypeSupport_cpp msgts(members);
-        ok = msgts.deserializeROSmessage(sd, ros_message, nullptr);
-      } else {
-        RMW_SET_ERROR_MSG("rmw_serialize: type support trouble");
-        return RMW_RET_ERROR;
-      }
-    }
+    ok = cached->deserialize(sd, ros_message);
   } catch (rmw_cyclonedds_cpp::Exception & e) {
-    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_serialize: %s", e.what());
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_deserialize: %s", e.what());
     ok = false;
   } catch (std::runtime_error & e) {
-    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_serialize: %s", e.what());
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_deserialize: %s", e.what());
     ok = false;
   }
 
@@ -1881,11 +2281,163 @@ void set_error_message_from_create_topic(dds_entity_t topic, const std::string &
 ///////////                                                                   ///////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
+using get_matched_endpoints_fn_t = dds_return_t (*)(
+  dds_entity_t h,
+  dds_instance_handle_t * xs, size_t nxs);
+using BuiltinTopicEndpoint = std::unique_ptr<dds_builtintopic_endpoint_t,
+    std::function<void (dds_builtintopic_endpoint_t *)>>;
+
+static rmw_ret_t get_matched_endpoints(
+  dds_entity_t h, get_matched_endpoints_fn_t fn, std::vector<dds_instance_handle_t> & res)
+{
+  dds_return_t ret;
+  if ((ret = fn(h, res.data(), res.size())) < 0) {
+    return RMW_RET_ERROR;
+  }
+  while (static_cast<size_t>(ret) >= res.size()) {
+    // 128 is a completely arbitrary margin to reduce the risk of having to retry
+    // when matches are create/deleted in parallel
+    res.resize(static_cast<size_t>(ret) + 128);
+    if ((ret = fn(h, res.data(), res.size())) < 0) {
+      return RMW_RET_ERROR;
+    }
+  }
+  res.resize(static_cast<size_t>(ret));
+  return RMW_RET_OK;
+}
+
+static void free_builtintopic_endpoint(dds_builtintopic_endpoint_t * e)
+{
+  dds_delete_qos(e->qos);
+  dds_free(e->topic_name);
+  dds_free(e->type_name);
+  dds_free(e);
+}
+
+static BuiltinTopicEndpoint get_matched_subscription_data(
+  dds_entity_t writer, dds_instance_handle_t readerih)
+{
+  BuiltinTopicEndpoint ep(dds_get_matched_subscription_data(writer, readerih),
+    free_builtintopic_endpoint);
+  return ep;
+}
+
+static BuiltinTopicEndpoint get_matched_publication_data(
+  dds_entity_t reader, dds_instance_handle_t writerih)
+{
+  BuiltinTopicEndpoint ep(dds_get_matched_publication_data(reader, writerih),
+    free_builtintopic_endpoint);
+  return ep;
+}
+
+/* The content filters of the readers matched with a publisher if each of them has one, i.e., if
+   there is no point in publishing a sample none of them accepts, or a null pointer otherwise */
+static std::shared_ptr<const ReaderFilterSet> matched_reader_filters(CddsPublisher * pub)
+{
+  MatchedReaderFilters * rf = pub->reader_filters.get();
+  if (rf == nullptr || rf->status.load(std::memory_order_acquire) == 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(rf->lock);
+  if (!(rf->status.load() & MatchedReaderFilters::Stale)) {
+    return rf->filters;
+  }
+  /* cleared first, so that a change while looking at the readers marks them stale again */
+  rf->status.fetch_and(~uint32_t{MatchedReaderFilters::Stale});
+  std::vector<dds_instance_handle_t> readers;
+  if (gcdds().have_reader_filters.load()) {
+    /* usually enough not to have to ask twice */
+    readers.resize(16);
+    if (get_matched_endpoints(pub->enth, dds_get_matched_subscriptions, readers) != RMW_RET_OK) {
+      rf->invalidate();
+      return nullptr;
+    }
+  }
+  const auto type = static_cast<const sertype_rmw *>(pub->sertype);
+  auto filters = std::make_shared<ReaderFilterSet>();
+  decltype(rf->compiled) compiled;
+  for (auto rdih : readers) {
+    auto rd = get_matched_subscription_data(pub->enth, rdih);
+    std::string key, expression;
+    std::vector<std::string> params;
+    if (rd == nullptr || !get_user_data_content_filter(rd->qos, key, expression, params)) {
+      filters = nullptr;
+      break;
+    }
+    if (compiled.count(key)) {
+      continue;
+    }
+    auto it = rf->compiled.find(key);
+    if (it != rf->compiled.end()) {
+      compiled.insert(*it);
+    } else {
+      try {
+        compiled[key] = std::make_shared<const rmw_cyclonedds_cpp::ContentFilter>(
+          type->registered_type->writer->root_value_type(), expression, params);
+      } catch (std::exception &) {
+        /* a filter written against a different definition of the type */
+        filters = nullptr;
+        break;
+      }
+    }
+    filters->push_back(compiled[key]);
+  }
+  if (filters != nullptr && filters->empty()) {
+    filters = nullptr;
+  }
+  if (filters != nullptr) {
+    rf->status.fetch_or(MatchedReaderFilters::Filtered);
+  } else {
+    rf->status.fetch_and(~uint32_t{MatchedReaderFilters::Filtered});
+  }
+  rf->filters = std::move(filters);
+  rf->compiled = std::move(compiled);
+  return rf->filters;
+}
+
+/* Whether a serialized sample is accepted by none of the filters */
+static bool rejected_by_readers(const ReaderFilterSet & filters, struct ddsi_serdata * dcmn)
+{
+  auto d = static_cast<serdata_rmw *>(dcmn);
+  serdata_rmw_make_contiguous(d);
+  for (const auto & filter : filters) {
+    if (filter->accepts(d->data(), d->size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Publish a message whose large arrays are referenced rather than copied, which is only safe
+   because the serdata is made independent of the message before returning */
+static rmw_ret_t publish_by_reference(CddsPublisher * pub, const void * ros_message)
+{
+  struct ddsi_serdata * d = serdata_rmw_from_sample_by_reference(pub->sertype, ros_message);
+  if (d == nullptr) {
+    return RMW_RET_ERROR;
+  }
+  /* keep a reference for copying the data if DDSI retains the serdata, e.g., in the writer
+     history cache */
+  dds_return_t ret = dds_writecdr(pub->enth, ddsi_serdata_ref(d));
+  if (!serdata_rmw_unreference_sample(d)) {
+    /* still being transmitted, which only happens if the writer batches samples: flushing the
+       writer sends the batch right away, so waiting for the references to be returned isn't
+       necessary, and might take forever if the transport holds on to them */
+    dds_write_flush(pub->enth);
+    serdata_rmw_detach_sample(d);
+  }
+  ddsi_serdata_unref(d);
+  if (ret < 0) {
+    RMW_SET_ERROR_MSG("failed to publish data");
+    return RMW_RET_ERROR;
+  }
+  return RMW_RET_OK;
+}
+
 extern "C" rmw_ret_t rmw_publish(
   const rmw_publisher_t * publisher, const void * ros_message,
   rmw_publisher_allocation_t * allocation)
 {
-  static_cast<void>(allocation);    // unused
   RMW_CHECK_FOR_NULL_WITH_MSG(
     publisher, "publisher handle is null",
     return RMW_RET_INVALID_ARGUMENT);
@@ -1898,7 +2450,55 @@ extern "C" rmw_ret_t rmw_publish(
   auto pub = static_cast<CddsPublisher *>(publisher->data);
   assert(pub);
   TRACEPOINT(rmw_publish, ros_message);
-  if (dds_write(pub->enth, ros_message) >= 0) {
+
+  auto reader_filters = matched_reader_filters(pub);
+  struct ddsi_serdata * d = nullptr;
+  if (allocation != nullptr) {
+    RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+      allocation, allocation->implementation_identifier, eclipse_cyclonedds_identifier,
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+    auto alloc = static_cast<CddsPublisherAllocation *>(allocation->data);
+#ifdef DDS_HAS_SHM
+    /* dds_write takes care of putting the sample in shared memory */
+    if (!dds_is_shared_memory_available(pub->enth))
+#endif
+    {
+      d = alloc->serialize(pub->sertype, ros_message);
+    }
+  }
+  if (d == nullptr && reader_filters != nullptr) {
+    /* the filters need the serialized sample, which dds_writecdr can then use */
+    d = ddsi_serdata_from_sample(pub->sertype, ddsi_serdata_kind::SDK_DATA, ros_message);
+    if (d == nullptr) {
+      RMW_SET_ERROR_MSG("failed to serialize data");
+      return RMW_RET_ERROR;
+    }
+  }
+  if (d != nullptr && reader_filters != nullptr && rejected_by_readers(*reader_filters, d)) {
+    ddsi_serdata_unref(d);
+    return RMW_RET_OK;
+  }
+#ifdef DDS_HAS_SHM
+  if (d != nullptr && dds_is_shared_memory_available(pub->enth)) {
+    /* only serialized for the filters, dds_write puts the sample in shared memory */
+    ddsi_serdata_unref(d);
+    d = nullptr;
+  }
+#endif
+  if (d != nullptr) {
+    if (dds_writecdr(pub->enth, d) >= 0) {
+      return RMW_RET_OK;
+    } else {
+      RMW_SET_ERROR_MSG("failed to publish data");
+      return RMW_RET_ERROR;
+    }
+  }
+
+  if (pub->publish_by_reference) {
+    return publish_by_reference(pub, ros_message);
+  }
+
+  if (dds_write(pub->enth, ros_message) >= 0) {
     return RMW_RET_OK;
   } else {
     RMW_SET_ERROR_MSG("failed to publish data");
@@ -1924,6 +2524,11 @@ extern "C" rmw_ret_t rmw_publish_serialized_message(
 
   struct ddsi_serdata * d = serdata_rmw_from_serialized_message(
     pub->sertype, serialized_message->buffer, serialized_message->buffer_length);
+  auto reader_filters = matched_reader_filters(pub);
+  if (d != nullptr && reader_filters != nullptr && rejected_by_readers(*reader_filters, d)) {
+    ddsi_serdata_unref(d);
+    return RMW_RET_OK;
+  }
 
 #ifdef DDS_HAS_SHM
   // publishing a serialized message when SHM is available
@@ -1941,11 +2546,56 @@ extern "C" rmw_ret_t rmw_publish_serialized_message(
   return ok ? RMW_RET_OK : RMW_RET_ERROR;
 }
 
+/* Publish a message borrowed from the loan pool of the publisher and take it back */
+static rmw_ret_t publish_pooled_loan(CddsPublisher * pub, void * ros_message)
+{
+  struct ddsi_serdata * d = nullptr;
+#ifdef DDS_HAS_SHM
+  /* dds_write takes care of putting the sample in shared memory */
+  if (!dds_is_shared_memory_available(pub->enth))
+#endif
+  {
+    d = pub->loan_pool->serialize(pub->sertype, ros_message);
+  }
+  auto reader_filters = matched_reader_filters(pub);
+  if (d == nullptr && reader_filters != nullptr) {
+    d = ddsi_serdata_from_sample(pub->sertype, ddsi_serdata_kind::SDK_DATA, ros_message);
+  }
+  const bool rejected =
+    d != nullptr && reader_filters != nullptr && rejected_by_readers(*reader_filters, d);
+#ifdef DDS_HAS_SHM
+  if (d != nullptr && !rejected && dds_is_shared_memory_available(pub->enth)) {
+    /* only serialized for the filters, dds_write puts the sample in shared memory */
+    ddsi_serdata_unref(d);
+    d = nullptr;
+  }
+#endif
+  dds_return_t ret;
+  if (rejected) {
+    ddsi_serdata_unref(d);
+    ret = DDS_RETCODE_OK;
+  } else if (d != nullptr) {
+    ret = dds_writecdr(pub->enth, d);
+  } else {
+    /* all serdata of the pool still in use by the writer */
+    ret = dds_write(pub->enth, ros_message);
+  }
+  /* the message has been serialized, so it is ours again, whether publishing worked or not */
+  if (!pub->loan_pool->give_back(ros_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned from this publisher");
+    return RMW_RET_ERROR;
+  }
+  if (ret < 0) {
+    RMW_SET_ERROR_MSG("Failed to publish data");
+    return RMW_RET_ERROR;
+  }
+  return RMW_RET_OK;
+}
+
 static rmw_ret_t publish_loaned_int(
   const rmw_publisher_t * publisher,
   void * ros_message)
 {
-#ifdef DDS_HAS_SHM
   RMW_CHECK_FOR_NULL_WITH_MSG(
     publisher, "publisher handle is null",
     return RMW_RET_INVALID_ARGUMENT);
@@ -1966,10 +2616,12 @@ static rmw_ret_t publish_loaned_int(
     return RMW_RET_ERROR;
   }
 
+#ifdef DDS_HAS_SHM
   // if the publisher allow loaning
   if (cdds_publisher->is_loaning_available) {
     auto d = new serdata_rmw(cdds_publisher->sertype, ddsi_serdata_kind::SDK_DATA);
     d->iox_chunk = ros_message;
+    d->defer_serialize();
     // since we write the loaned chunk here, set the data state to raw
     shm_set_data_state(d->iox_chunk, IOX_CHUNK_CONTAINS_RAW_DATA);
     if (dds_writecdr(cdds_publisher->enth, d) >= 0) {
@@ -1980,17 +2632,9 @@ static rmw_ret_t publish_loaned_int(
       ddsi_serdata_unref(d);
       return RMW_RET_ERROR;
     }
-  } else {
-    RMW_SET_ERROR_MSG("Publishing a loaned message of non fixed type is not allowed");
-    return RMW_RET_ERROR;
   }
-  return RMW_RET_OK;
-#else
-  static_cast<void>(publisher);
-  static_cast<void>(ros_message);
-  RMW_SET_ERROR_MSG("rmw_publish_loaned_message not implemented for rmw_cyclonedds_cpp");
-  return RMW_RET_UNSUPPORTED;
 #endif
+  return publish_pooled_loan(cdds_publisher, ros_message);
 }
 
 extern "C" rmw_ret_t rmw_publish_loaned_message(
@@ -2319,32 +2963,6 @@ static bool dds_qos_to_rmw_qos(const dds_qos_t * dds_qos, rmw_qos_profile_t * qo
   return true;
 }
 
-static bool is_type_self_contained(const rosidl_message_type_support_t * type_supports)
-{
-  auto ts = get_message_typesupport_handle(
-    type_supports,
-    rosidl_typesupport_introspection_cpp::typesupport_identifier);
-  if (ts != nullptr) {   // CPP typesupport
-    auto members = static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(
-      ts->data);
-    MessageTypeSupport_cpp mts(members);
-    return mts.is_type_self_contained();
-  } else {
-    ts = get_message_typesupport_handle(
-      type_supports,
-      rosidl_typesupport_introspection_c__identifier);
-    if (ts != nullptr) {  // C typesupport
-      auto members = static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(
-        ts->data);
-      MessageTypeSupport_c mts(members);
-      return mts.is_type_self_contained();
-    } else {
-      RMW_SET_ERROR_MSG("Non supported type-supported");
-      return false;
-    }
-  }
-}
-
 static CddsPublisher * create_cdds_publisher(
   dds_entity_t dds_ppant, dds_entity_t dds_pub,
   const rosidl_message_type_support_t * type_supports,
@@ -2355,20 +2973,31 @@ static CddsPublisher * create_cdds_publisher(
   RET_NULL_X(qos_policies, return nullptr);
   const rosidl_message_type_support_t * type_support = get_typesupport(type_supports);
   RET_NULL_X(type_support, return nullptr);
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> registered_type;
+  try {
+    registered_type = rmw_cyclonedds_cpp::get_registered_message_type(type_support);
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return nullptr;
+  }
   CddsPublisher * pub = new CddsPublisher();
   dds_entity_t topic;
   dds_qos_t * qos;
 
   std::string fqtopic_name = make_fqtopic(ROS_TOPIC_PREFIX, topic_name, "", qos_policies);
-  bool is_fixed_type = is_type_self_contained(type_support);
-  uint32_t sample_size = static_cast<uint32_t>(rmw_cyclonedds_cpp::get_message_size(type_support));
-  auto sertype = create_sertype(
-    type_support->typesupport_identifier,
-    create_message_type_support(type_support->data, type_support->typesupport_identifier), false,
-    rmw_cyclonedds_cpp::make_message_value_type(type_supports), sample_size, is_fixed_type);
+  bool is_fixed_type = registered_type->is_fixed_type;
+  uint32_t sample_size = registered_type->sample_size;
+  auto sertype = create_sertype(std::move(registered_type));
   struct ddsi_sertype * stact = nullptr;
   topic = create_topic(dds_ppant, fqtopic_name.c_str(), sertype, &stact);
 
+  /* a sample no current reader wants can't be skipped if a late-joining reader may still get
+     it from the history; the filters exist before the writer, as its listener invalidates them */
+  if (qos_policies->durability != RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL) {
+    pub->reader_filters = std::make_unique<MatchedReaderFilters>();
+    pub->user_callback_data.reader_filters = pub->reader_filters.get();
+  }
+
   dds_listener_t * listener = dds_create_listener(&pub->user_callback_data);
   // Set the corresponding callbacks to listen for events
   listener_set_event_callbacks(listener, &pub->user_callback_data);
@@ -2394,6 +3023,19 @@ static CddsPublisher * create_cdds_publisher(
   pub->type_supports = *type_supports;
   pub->is_loaning_available = is_fixed_type && dds_is_loan_available(pub->enth);
   pub->sample_size = sample_size;
+  if (!pub->is_loaning_available) {
+    pub->loan_pool = std::make_unique<PublisherLoanPool>(pub->type_supports, sample_size);
+  }
+  /* the writer history cache of a reliable or transient-local writer keeps the sample, and
+     with it a copy of the referenced data, so there's nothing to be gained */
+  pub->publish_by_reference =
+    static_cast<const sertype_rmw *>(stact)->serialize_by_reference &&
+    qos_policies->reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT &&
+    qos_policies->durability != RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+#ifdef DDS_HAS_SHM
+  pub->publish_by_reference =
+    pub->publish_by_reference && !dds_is_shared_memory_available(pub->enth);
+#endif
   dds_delete_qos(qos);
   dds_delete(topic);
   return pub;
@@ -2415,18 +3057,45 @@ extern "C" rmw_ret_t rmw_init_publisher_allocation(
   const rosidl_message_type_support_t * type_support,
   const rosidl_runtime_c__Sequence__bound * message_bounds, rmw_publisher_allocation_t * allocation)
 {
-  static_cast<void>(type_support);
-  static_cast<void>(message_bounds);
-  static_cast<void>(allocation);
-  RMW_SET_ERROR_MSG("rmw_init_publisher_allocation: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+
+  const rmw_cyclonedds_cpp_sequence_bounds_t * bounds;
+  if (!get_sequence_bounds(message_bounds, &bounds)) {
+    RMW_SET_ERROR_MSG(
+      "rmw_init_publisher_allocation: message bounds not from this implementation");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  try {
+    /* without a bound on the size, the buffers are allocated by the first messages and keep
+       their capacity from then on */
+    size_t payload_capacity;
+    auto cached = rmw_cyclonedds_cpp::get_serialization_cache_entry(type_support);
+    if (!cached->get_max_serialized_size(bounds, payload_capacity)) {
+      payload_capacity = 0;
+    }
+    /* room for the padding serdata_rmw::resize adds */
+    payload_capacity += (0 - payload_capacity) % 4;
+    allocation->data = new CddsPublisherAllocation(payload_capacity);
+    allocation->implementation_identifier = eclipse_cyclonedds_identifier;
+    return RMW_RET_OK;
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_init_publisher_allocation: %s", e.what());
+    return RMW_RET_ERROR;
+  }
 }
 
 extern "C" rmw_ret_t rmw_fini_publisher_allocation(rmw_publisher_allocation_t * allocation)
 {
-  static_cast<void>(allocation);
-  RMW_SET_ERROR_MSG("rmw_fini_publisher_allocation: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation, allocation->implementation_identifier, eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  delete static_cast<CddsPublisherAllocation *>(allocation->data);
+  allocation->data = nullptr;
+  allocation->implementation_identifier = nullptr;
+  return RMW_RET_OK;
 }
 
 static rmw_publisher_t * create_publisher(
@@ -2465,7 +3134,7 @@ static rmw_publisher_t * create_publisher(
   RET_ALLOC_X(rmw_publisher->topic_name, return nullptr);
   memcpy(const_cast<char *>(rmw_publisher->topic_name), topic_name, strlen(topic_name) + 1);
   rmw_publisher->options = *publisher_options;
-  rmw_publisher->can_loan_messages = pub->is_loaning_available;
+  rmw_publisher->can_loan_messages = pub->is_loaning_available || pub->loan_pool != nullptr;
 
   cleanup_rmw_publisher.cancel();
   cleanup_cdds_publisher.cancel();
@@ -2706,7 +3375,6 @@ static rmw_ret_t borrow_loaned_message_int(
   const rosidl_message_type_support_t * type_support,
   void ** ros_message)
 {
-#ifdef DDS_HAS_SHM
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
   if (!publisher->can_loan_messages) {
     RMW_SET_ERROR_MSG("Loaning is not supported");
@@ -2728,23 +3396,25 @@ static rmw_ret_t borrow_loaned_message_int(
     return RMW_RET_ERROR;
   }
 
+#ifdef DDS_HAS_SHM
   // if the publisher can loan
   if (cdds_publisher->is_loaning_available) {
     auto sample_ptr = init_and_alloc_sample(cdds_publisher, cdds_publisher->sample_size);
     RET_NULL_X(sample_ptr, return RMW_RET_ERROR);
     *ros_message = sample_ptr;
     return RMW_RET_OK;
-  } else {
-    RMW_SET_ERROR_MSG("Borrowing loan for a non fixed type is not allowed");
-    return RMW_RET_ERROR;
   }
-#else
-  (void) publisher;
-  (void) type_support;
-  (void) ros_message;
-  RMW_SET_ERROR_MSG("rmw_borrow_loaned_message not implemented for rmw_cyclonedds_cpp");
-  return RMW_RET_UNSUPPORTED;
 #endif
+  try {
+    *ros_message = cdds_publisher->loan_pool->borrow();
+    return RMW_RET_OK;
+  } catch (std::bad_alloc &) {
+    RMW_SET_ERROR_MSG("out of memory borrowing a message");
+    return RMW_RET_BAD_ALLOC;
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return RMW_RET_ERROR;
+  }
 }
 
 extern "C" rmw_ret_t rmw_borrow_loaned_message(
@@ -2759,7 +3429,6 @@ static rmw_ret_t return_loaned_message_from_publisher_int(
   const rmw_publisher_t * publisher,
   void * loaned_message)
 {
-#ifdef DDS_HAS_SHM
   RCUTILS_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
   if (!publisher->can_loan_messages) {
     RMW_SET_ERROR_MSG("Loaning is not supported");
@@ -2778,20 +3447,17 @@ static rmw_ret_t return_loaned_message_from_publisher_int(
     return RMW_RET_ERROR;
   }
 
+#ifdef DDS_HAS_SHM
   // if the publisher can loan
   if (cdds_publisher->is_loaning_available) {
     return fini_and_free_sample(cdds_publisher, loaned_message);
-  } else {
-    RMW_SET_ERROR_MSG("returning loan for a non fixed type is not allowed");
-    return RMW_RET_ERROR;
   }
-#else
-  (void) publisher;
-  (void) loaned_message;
-  RMW_SET_ERROR_MSG(
-    "rmw_return_loaned_message_from_publisher not implemented for rmw_cyclonedds_cpp");
-  return RMW_RET_UNSUPPORTED;
 #endif
+  if (!cdds_publisher->loan_pool->give_back(loaned_message)) {
+    RMW_SET_ERROR_MSG("message was not loaned from this publisher");
+    return RMW_RET_ERROR;
+  }
+  return RMW_RET_OK;
 }
 
 extern "C" rmw_ret_t rmw_return_loaned_message_from_publisher(
@@ -2877,6 +3543,22 @@ extern "C" rmw_ret_t rmw_destroy_publisher(rmw_node_t * node, rmw_publisher_t *
 ///////////                                                                   ///////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
+/* Loaning received messages without shared memory (see take_serdata_loan) costs a take and some
+   bookkeeping per message, and applications using loans by default when available (rclcpp)
+   would pay it for every message of a memcpy-serialized type.  So it is only done when asked for
+   by setting RMW_CYCLONEDDS_LOAN_RECEIVED_MESSAGES=1. */
+static bool loan_received_messages_enabled()
+{
+  static const bool enabled = []() {
+      const char * value;
+      if (rcutils_get_env("RMW_CYCLONEDDS_LOAN_RECEIVED_MESSAGES", &value) != nullptr) {
+        return false;
+      }
+      return strcmp(value, "1") == 0;
+    }();
+  return enabled;
+}
+
 static CddsSubscription * create_cdds_subscription(
   dds_entity_t dds_ppant, dds_entity_t dds_sub,
   const rosidl_message_type_support_t * type_supports, const char * topic_name,
@@ -2886,17 +3568,23 @@ static CddsSubscription * create_cdds_subscription(
   RET_NULL_X(qos_policies, return nullptr);
   const rosidl_message_type_support_t * type_support = get_typesupport(type_supports);
   RET_NULL_X(type_support, return nullptr);
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> registered_type;
+  try {
+    registered_type = rmw_cyclonedds_cpp::get_registered_message_type(type_support);
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return nullptr;
+  }
   CddsSubscription * sub = new CddsSubscription();
   dds_entity_t topic;
   dds_qos_t * qos;
 
   std::string fqtopic_name = make_fqtopic(ROS_TOPIC_PREFIX, topic_name, "", qos_policies);
-  bool is_fixed_type = is_type_self_contained(type_support);
-  uint32_t sample_size = static_cast<uint32_t>(rmw_cyclonedds_cpp::get_message_size(type_support));
-  auto sertype = create_sertype(
-    type_support->typesupport_identifier,
-    create_message_type_support(type_support->data, type_support->typesupport_identifier), false,
-    rmw_cyclonedds_cpp::make_message_value_type(type_supports), sample_size, is_fixed_type);
+  bool is_fixed_type = registered_type->is_fixed_type;
+  sub->serdata_loaning_available =
+    registered_type->is_memcpy_serialized && loan_received_messages_enabled();
+  sub->registered_type = registered_type;
+  auto sertype = create_sertype(std::move(registered_type));
   topic = create_topic(dds_ppant, fqtopic_name.c_str(), sertype);
 
   dds_listener_t * listener = dds_create_listener(&sub->user_callback_data);
@@ -2926,8 +3614,8 @@ static CddsSubscription * create_cdds_subscription(
   dds_delete_listener(listener);
   sub->type_supports = *type_support;
   sub->is_loaning_available = is_fixed_type && dds_is_loan_available(sub->enth);
+  sub->topic = topic;
   dds_delete_qos(qos);
-  dds_delete(topic);
   return sub;
 fail_readcond:
   if (dds_delete(sub->enth) < 0) {
@@ -2947,18 +3635,31 @@ extern "C" rmw_ret_t rmw_init_subscription_allocation(
   const rosidl_runtime_c__Sequence__bound * message_bounds,
   rmw_subscription_allocation_t * allocation)
 {
-  static_cast<void>(type_support);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  /* deserializing reuses the buffers of the messages taken into, so there is nothing to
+     size from the message bounds */
   static_cast<void>(message_bounds);
-  static_cast<void>(allocation);
-  RMW_SET_ERROR_MSG("rmw_init_subscription_allocation: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  try {
+    allocation->data = new CddsSubscriptionAllocation();
+    allocation->implementation_identifier = eclipse_cyclonedds_identifier;
+    return RMW_RET_OK;
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("rmw_init_subscription_allocation: %s", e.what());
+    return RMW_RET_ERROR;
+  }
 }
 
 extern "C" rmw_ret_t rmw_fini_subscription_allocation(rmw_subscription_allocation_t * allocation)
 {
-  static_cast<void>(allocation);
-  RMW_SET_ERROR_MSG("rmw_fini_subscription_allocation: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(allocation, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    allocation, allocation->implementation_identifier, eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  delete static_cast<CddsSubscriptionAllocation *>(allocation->data);
+  allocation->data = nullptr;
+  allocation->implementation_identifier = nullptr;
+  return RMW_RET_OK;
 }
 
 static rmw_subscription_t * create_subscription(
@@ -2988,6 +3689,7 @@ static rmw_subscription_t * create_subscription(
           "failed to delete reader during '"
           RCUTILS_STRINGIFY(__function__) "' cleanup\n");
       }
+      dds_delete(sub->topic);
       delete sub;
     });
   rmw_subscription = rmw_subscription_allocate();
@@ -3004,8 +3706,17 @@ static rmw_subscription_t * create_subscription(
   RET_ALLOC_X(rmw_subscription->topic_name, return nullptr);
   memcpy(const_cast<char *>(rmw_subscription->topic_name), topic_name, strlen(topic_name) + 1);
   rmw_subscription->options = *subscription_options;
-  rmw_subscription->can_loan_messages = sub->is_loaning_available;
+  /* the subscription keeps a filter of its own */
+  rmw_subscription->options.content_filter_options = nullptr;
+  rmw_subscription->can_loan_messages =
+    sub->is_loaning_available || sub->serdata_loaning_available;
   rmw_subscription->is_cft_enabled = false;
+  if (subscription_options->content_filter_options != nullptr &&
+    rmw_subscription_set_content_filter(
+      rmw_subscription, subscription_options->content_filter_options) != RMW_RET_OK)
+  {
+    return nullptr;
+  }
 
   cleanup_subscription.cancel();
   cleanup_rmw_subscription.cancel();
@@ -3138,15 +3849,98 @@ extern "C" rmw_ret_t rmw_subscription_get_actual_qos(
   return RMW_RET_ERROR;
 }
 
+/* Advertise the content filter of a subscription in the USER_DATA of its reader, in place of
+   the one advertised before, so that publishers can skip the samples it doesn't accept */
+static bool advertise_content_filter(
+  const CddsSubscription * sub, const rmw_cyclonedds_cpp::ContentFilter * filter)
+{
+  dds_qos_t * qos = dds_create_qos();
+  RCPPUTILS_SCOPE_EXIT(dds_delete_qos(qos));
+  if (dds_get_qos(sub->enth, qos) < 0) {
+    return false;
+  }
+  std::string user_data = filter ? content_filter_user_data(*filter) : "";
+  void * ud;
+  size_t udsz;
+  if (dds_qget_userdata(qos, &ud, &udsz) && ud != nullptr) {
+    std::string old_user_data(static_cast<const char *>(ud), udsz);
+    dds_free(ud);
+    size_t pos = 0, end;
+    while ((end = old_user_data.find(';', pos)) != std::string::npos) {
+      std::string entry = old_user_data.substr(pos, end + 1 - pos);
+      if (entry.compare(0, 7, "filter=") != 0 && entry.compare(0, 13, "filterparams=") != 0) {
+        user_data += entry;
+      }
+      pos = end + 1;
+    }
+  }
+  dds_qos_t * new_qos = dds_create_qos();
+  RCPPUTILS_SCOPE_EXIT(dds_delete_qos(new_qos));
+  dds_qset_userdata(new_qos, user_data.data(), user_data.size());
+  return dds_set_qos(sub->enth, new_qos) >= 0;
+}
+
+/* Evaluated by Cyclone on every sample before it is stored in the history of the reader */
+static bool content_filter_accepts(const void * sample, void * arg)
+{
+  auto sub = static_cast<const CddsSubscription *>(arg);
+  auto filter = std::atomic_load(&sub->content_filter);
+  auto d = static_cast<const serdata_rmw_filter_sample *>(sample)->serdata;
+  if (filter == nullptr || d == nullptr) {
+    return true;
+  }
+  serdata_rmw_make_contiguous(const_cast<serdata_rmw *>(d));
+  return filter->accepts(d->data(), d->size());
+}
+
 extern "C" rmw_ret_t rmw_subscription_set_content_filter(
   rmw_subscription_t * subscription,
   const rmw_subscription_content_filter_options_t * options)
 {
-  static_cast<void>(subscription);
-  static_cast<void>(options);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(options, RMW_RET_INVALID_ARGUMENT);
+  auto sub = static_cast<CddsSubscription *>(subscription->data);
 
-  RMW_SET_ERROR_MSG("rmw_subscription_set_content_filter: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  /* an empty expression removes the filter */
+  std::shared_ptr<const rmw_cyclonedds_cpp::ContentFilter> filter;
+  if (options->filter_expression != nullptr && options->filter_expression[0] != '\0') {
+    try {
+      const auto & params = options->expression_parameters;
+      filter = std::make_shared<const rmw_cyclonedds_cpp::ContentFilter>(
+        sub->registered_type->writer->root_value_type(), options->filter_expression,
+        std::vector<std::string>(params.data, params.data + params.size));
+    } catch (std::invalid_argument & e) {
+      RMW_SET_ERROR_MSG(e.what());
+      return RMW_RET_INVALID_ARGUMENT;
+    } catch (std::bad_alloc &) {
+      RMW_SET_ERROR_MSG("out of memory compiling content filter");
+      return RMW_RET_BAD_ALLOC;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(sub->content_filter_lock);
+  if (!advertise_content_filter(sub, filter.get())) {
+    RMW_SET_ERROR_MSG("failed to advertise content filter");
+    return RMW_RET_ERROR;
+  }
+  struct dds_topic_filter topic_filter;
+  topic_filter.mode = filter ? DDS_TOPIC_FILTER_SAMPLE_ARG : DDS_TOPIC_FILTER_NONE;
+  topic_filter.f.sample_arg = content_filter_accepts;
+  topic_filter.arg = sub;
+  auto old_filter = std::atomic_exchange(&sub->content_filter, filter);
+  if (dds_set_topic_filter_extended(sub->topic, &topic_filter) < 0) {
+    std::atomic_store(&sub->content_filter, old_filter);
+    advertise_content_filter(sub, old_filter.get());
+    RMW_SET_ERROR_MSG("failed to set content filter");
+    return RMW_RET_ERROR;
+  }
+  subscription->is_cft_enabled = filter != nullptr;
+  return RMW_RET_OK;
 }
 
 extern "C" rmw_ret_t rmw_subscription_get_content_filter(
@@ -3154,12 +3948,28 @@ extern "C" rmw_ret_t rmw_subscription_get_content_filter(
   rcutils_allocator_t * allocator,
   rmw_subscription_content_filter_options_t * options)
 {
-  static_cast<void>(subscription);
-  static_cast<void>(allocator);
-  static_cast<void>(options);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RCUTILS_CHECK_ALLOCATOR_WITH_MSG(
+    allocator, "allocator argument is invalid", return RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(options, RMW_RET_INVALID_ARGUMENT);
+  auto sub = static_cast<const CddsSubscription *>(subscription->data);
 
-  RMW_SET_ERROR_MSG("rmw_subscription_get_content_filter: unimplemented");
-  return RMW_RET_UNSUPPORTED;
+  auto filter = std::atomic_load(&sub->content_filter);
+  if (filter == nullptr) {
+    RMW_SET_ERROR_MSG("subscription has no content filter");
+    return RMW_RET_ERROR;
+  }
+  std::vector<const char *> params;
+  for (const auto & param : filter->parameters()) {
+    params.push_back(param.c_str());
+  }
+  return rmw_subscription_content_filter_options_init(
+    filter->expression().c_str(), params.size(), params.data(), allocator, options);
 }
 
 static rmw_ret_t destroy_subscription(rmw_subscription_t * subscription)
@@ -3179,6 +3989,7 @@ static rmw_ret_t destroy_subscription(rmw_subscription_t * subscription)
       RMW_SAFE_FWRITE_TO_STDERR("failed to delete reader\n");
     }
   }
+  dds_delete(sub->topic);
   delete sub;
   rmw_free(const_cast<char *>(subscription->topic_name));
   rmw_subscription_free(subscription);
@@ -3296,12 +4107,81 @@ take_done:
   return RMW_RET_OK;
 }
 
+static rmw_cyclonedds_cpp_instance_state_t instance_state_from_sample_info(
+  const dds_sample_info_t & info)
+{
+  switch (info.instance_state) {
+    case DDS_IST_ALIVE:
+      return RMW_CYCLONEDDS_CPP_INSTANCE_ALIVE;
+    case DDS_IST_NOT_ALIVE_DISPOSED:
+      return RMW_CYCLONEDDS_CPP_INSTANCE_DISPOSED;
+    case DDS_IST_NOT_ALIVE_NO_WRITERS:
+      return RMW_CYCLONEDDS_CPP_INSTANCE_NO_WRITERS;
+  }
+  rmw_cyclonedds_cpp::unreachable();
+}
+
+static std::mutex take_executor_lock;
+static rmw_cyclonedds_cpp_executor_t take_executor = nullptr;
+static void * take_executor_arg = nullptr;
+
+struct DeserializeBatch
+{
+  struct ddsi_serdata * const * serdatas;
+  void * const * messages;
+  std::atomic<bool> ok;
+};
+
+static void deserialize_batch_element(void * arg, size_t index)
+{
+  auto batch = static_cast<DeserializeBatch *>(arg);
+  if (!ddsi_serdata_to_sample(batch->serdatas[index], batch->messages[index], nullptr, nullptr)) {
+    batch->ok.store(false, std::memory_order_relaxed);
+  }
+}
+
+/* Deserialize n serdatas into the corresponding messages and release them, spreading the work
+   over the application's executor or the RMW's worker pool if parallel is set */
+static bool deserialize_taken(
+  struct ddsi_serdata * const * serdatas, void * const * messages, size_t n, bool parallel)
+{
+  DeserializeBatch batch;
+  batch.serdatas = serdatas;
+  batch.messages = messages;
+  batch.ok = true;
+  if (!parallel || n < 2) {
+    for (size_t i = 0; i < n; i++) {
+      deserialize_batch_element(&batch, i);
+    }
+  } else {
+    rmw_cyclonedds_cpp_executor_t executor;
+    void * executor_arg;
+    {
+      std::lock_guard<std::mutex> lock(take_executor_lock);
+      executor = take_executor;
+      executor_arg = take_executor_arg;
+    }
+    if (executor) {
+      executor(deserialize_batch_element, &batch, n, executor_arg);
+    } else {
+      rmw_cyclonedds_cpp::WorkerPool::get().run(deserialize_batch_element, &batch, n);
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    ddsi_serdata_unref(serdatas[i]);
+  }
+  return batch.ok.load(std::memory_order_relaxed);
+}
+
+/* Takes into the messages of message_sequence, moving the ones that got data to the front.
+   Samples without data are returned in invalid_samples if that isn't a null pointer. */
 static rmw_ret_t rmw_take_seq(
   const rmw_subscription_t * subscription,
   size_t count,
   rmw_message_sequence_t * message_sequence,
   rmw_message_info_sequence_t * message_info_sequence,
-  size_t * taken)
+  rmw_cyclonedds_cpp_invalid_sample_t * invalid_samples, size_t * n_invalid,
+  size_t * taken, CddsSubscriptionAllocation * allocation)
 {
   RMW_CHECK_ARGUMENT_FOR_NULL(
     taken, RMW_RET_INVALID_ARGUMENT);
@@ -3346,43 +4226,75 @@ static rmw_ret_t rmw_take_seq(
   CddsSubscription * sub = static_cast<CddsSubscription *>(subscription->data);
   RET_NULL(sub);
 
-  std::vector<dds_sample_info_t> infos(count);
+  // Scratch space, from the allocation if there is one
+  std::unique_lock<std::mutex> scratch_lock;
+  TakeSequenceScratch * scratch;
+  if (allocation) {
+    scratch = &allocation->scratch;
+  } else {
+    scratch_lock = std::unique_lock<std::mutex>(sub->take_seq_lock);
+    scratch = &sub->take_seq_scratch;
+  }
+  scratch->reserve(count);
+
+  // With parallel deserialization enabled, take the serialized data so that it can be
+  // deserialized once it is known whether that is worth doing in parallel
+  const size_t parallel_min_size = sub->parallel_take_min_size.load(std::memory_order_relaxed);
+  const bool take_cdr = parallel_min_size > 0 && count > 1;
   auto maxsamples = static_cast<uint32_t>(count);
-  auto ret = dds_take(sub->enth, message_sequence->data, infos.data(), count, maxsamples);
+  dds_return_t ret;
+  if (take_cdr) {
+    ret = dds_takecdr(
+      sub->enth, scratch->serdatas.data(), maxsamples, scratch->infos.data(), DDS_ANY_STATE);
+  } else {
+    ret = dds_take(
+      sub->enth, message_sequence->data, scratch->infos.data(), count, maxsamples);
+  }
 
   // Returning 0 should not be an error, as it just indicates that no messages were available.
   if (ret < 0) {
     return RMW_RET_ERROR;
   }
 
-  // Keep track of taken/not taken to reorder sequence with valid messages at the front
-  std::vector<void *> taken_msg;
-  std::vector<void *> not_taken_msg;
+  // Move the messages that got data to the front, keeping their order.  Swapping rather than
+  // overwriting keeps every message of the sequence in it.
   *taken = 0u;
-
+  size_t invalid = 0;
+  bool parallel = false;
   for (int ii = 0; ii < ret; ++ii) {
-    const dds_sample_info_t & info = infos[ii];
-
-    void * message = &message_sequence->data[ii];
-    rmw_message_info_t * message_info = &message_info_sequence->data[*taken];
-
+    const dds_sample_info_t & info = scratch->infos[ii];
     if (info.valid_data) {
-      taken_msg.push_back(message);
-      (*taken)++;
-      if (message_info) {
-        message_info_from_sample_info(info, message_info);
+      std::swap(message_sequence->data[*taken], message_sequence->data[ii]);
+      if (take_cdr) {
+        struct ddsi_serdata * d = scratch->serdatas[ii];
+        scratch->serdatas[*taken] = d;
+        parallel = parallel || ddsi_serdata_size(d) >= parallel_min_size;
       }
+      message_info_from_sample_info(info, &message_info_sequence->data[*taken]);
+      (*taken)++;
     } else {
-      not_taken_msg.push_back(message);
+      if (take_cdr) {
+        ddsi_serdata_unref(scratch->serdatas[ii]);
+      }
+      if (invalid_samples) {
+        message_info_from_sample_info(info, &invalid_samples[invalid].info);
+        invalid_samples[invalid].instance_state = instance_state_from_sample_info(info);
+        invalid++;
+      }
     }
   }
-
-  for (size_t ii = 0; ii < taken_msg.size(); ++ii) {
-    message_sequence->data[ii] = taken_msg[ii];
+  if (n_invalid) {
+    *n_invalid = invalid;
   }
 
-  for (size_t ii = 0; ii < not_taken_msg.size(); ++ii) {
-    message_sequence->data[ii + taken_msg.size()] = not_taken_msg[ii];
+  if (take_cdr &&
+    !deserialize_taken(scratch->serdatas.data(), message_sequence->data, *taken, parallel))
+  {
+    RMW_SET_ERROR_MSG("rmw_take_sequence: failed to deserialize a message");
+    *taken = 0;
+    message_sequence->size = 0;
+    message_info_sequence->size = 0;
+    return RMW_RET_ERROR;
   }
 
   message_sequence->size = *taken;
@@ -3471,33 +4383,11 @@ static rmw_ret_t rmw_take_ser_int(
   return RMW_RET_OK;
 }
 
-static rmw_ret_t rmw_take_loan_int(
-  const rmw_subscription_t * subscription,
-  void ** loaned_message,
-  bool * taken,
+#ifdef DDS_HAS_SHM
+static rmw_ret_t take_iox_loan(
+  CddsSubscription * cdds_subscription, void ** loaned_message, bool * taken,
   rmw_message_info_t * message_info)
 {
-#ifdef DDS_HAS_SHM
-  RMW_CHECK_ARGUMENT_FOR_NULL(
-    subscription, RMW_RET_INVALID_ARGUMENT);
-  if (!subscription->can_loan_messages) {
-    RMW_SET_ERROR_MSG("Loaning is not supported");
-    return RMW_RET_UNSUPPORTED;
-  }
-  RMW_CHECK_ARGUMENT_FOR_NULL(
-    loaned_message, RMW_RET_INVALID_ARGUMENT);
-  RMW_CHECK_ARGUMENT_FOR_NULL(
-    taken, RMW_RET_INVALID_ARGUMENT);
-  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
-    subscription handle,
-    subscription->implementation_identifier, eclipse_cyclonedds_identifier,
-    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
-  auto cdds_subscription = static_cast<CddsSubscription *>(subscription->data);
-  if (!cdds_subscription) {
-    RMW_SET_ERROR_MSG("Subscription data is null");
-    return RMW_RET_ERROR;
-  }
-
   dds_sample_info_t info;
   struct ddsi_serdata * d;
   while (dds_takecdr(cdds_subscription->enth, &d, 1, &info, DDS_ANY_STATE) == 1) {
@@ -3560,14 +4450,100 @@ static rmw_ret_t rmw_take_loan_int(
   }
   *taken = false;
   return RMW_RET_OK;
-#else
-  static_cast<void>(subscription);
-  static_cast<void>(loaned_message);
-  static_cast<void>(taken);
-  static_cast<void>(message_info);
-  RMW_SET_ERROR_MSG("rmw_take_loaned_message not implemented for rmw_cyclonedds_cpp");
-  return RMW_RET_UNSUPPORTED;
+}
+#endif
+
+/* Loan out a message of a memcpy-serialized type received over the network: the serialized
+   data is the CDR header followed by the message as it is laid out in memory, so the message
+   can be used in place while the serdata is kept alive.  If the data is in the other byte
+   order or happens to be misaligned, the message is deserialized into memory of its own. */
+static rmw_ret_t take_serdata_loan(
+  CddsSubscription * cdds_subscription, void ** loaned_message, bool * taken,
+  rmw_message_info_t * message_info)
+{
+  dds_sample_info_t info;
+  struct ddsi_serdata * dcmn;
+  while (dds_takecdr(cdds_subscription->enth, &dcmn, 1, &info, DDS_ANY_STATE) == 1) {
+    if (!info.valid_data) {
+      ddsi_serdata_unref(dcmn);
+      continue;
+    }
+    auto d = static_cast<serdata_rmw *>(dcmn);
+    serdata_rmw_make_contiguous(d);
+    const void * message = serdata_rmw_sample_in_place(d);
+    try {
+      if (message == nullptr) {
+        auto type = static_cast<const struct sertype_rmw *>(d->type);
+        size_t sample_size = type->registered_type->sample_size;
+        void * copy = ::operator new(sample_size);
+        memset(copy, 0, sample_size);
+        if (!ddsi_serdata_to_sample(d, copy, nullptr, nullptr)) {
+          ::operator delete(copy);
+          ddsi_serdata_unref(d);
+          RMW_SET_ERROR_MSG("failed to deserialize sample");
+          *taken = false;
+          return RMW_RET_ERROR;
+        }
+        ddsi_serdata_unref(d);
+        d = nullptr;
+        message = copy;
+      }
+      std::lock_guard<std::mutex> lock(cdds_subscription->loans_lock);
+      cdds_subscription->loans.emplace_back(message, d);
+    } catch (std::bad_alloc &) {
+      if (d != nullptr) {
+        ddsi_serdata_unref(d);
+      } else {
+        ::operator delete(const_cast<void *>(message));
+      }
+      RMW_SET_ERROR_MSG("out of memory loaning a message");
+      *taken = false;
+      return RMW_RET_BAD_ALLOC;
+    }
+    if (message_info) {
+      message_info_from_sample_info(info, message_info);
+    }
+    /* the message is only ever read by the application, the const goes with the loan */
+    *loaned_message = const_cast<void *>(message);
+    *taken = true;
+    return RMW_RET_OK;
+  }
+  *taken = false;
+  return RMW_RET_OK;
+}
+
+static rmw_ret_t rmw_take_loan_int(
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_message_info_t * message_info)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    subscription, RMW_RET_INVALID_ARGUMENT);
+  if (!subscription->can_loan_messages) {
+    RMW_SET_ERROR_MSG("Loaning is not supported");
+    return RMW_RET_UNSUPPORTED;
+  }
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    taken, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription handle,
+    subscription->implementation_identifier, eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  auto cdds_subscription = static_cast<CddsSubscription *>(subscription->data);
+  if (!cdds_subscription) {
+    RMW_SET_ERROR_MSG("Subscription data is null");
+    return RMW_RET_ERROR;
+  }
+
+#ifdef DDS_HAS_SHM
+  if (cdds_subscription->is_loaning_available) {
+    return take_iox_loan(cdds_subscription, loaned_message, taken, message_info);
+  }
 #endif
+  return take_serdata_loan(cdds_subscription, loaned_message, taken, message_info);
 }
 
 extern "C" rmw_ret_t rmw_take(
@@ -3594,8 +4570,60 @@ extern "C" rmw_ret_t rmw_take_sequence(
   rmw_message_info_sequence_t * message_info_sequence,
   size_t * taken, rmw_subscription_allocation_t * allocation)
 {
-  static_cast<void>(allocation);
-  return rmw_take_seq(subscription, count, message_sequence, message_info_sequence, taken);
+  CddsSubscriptionAllocation * alloc = nullptr;
+  if (allocation != nullptr) {
+    RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+      allocation, allocation->implementation_identifier, eclipse_cyclonedds_identifier,
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+    alloc = static_cast<CddsSubscriptionAllocation *>(allocation->data);
+  }
+  return rmw_take_seq(
+    subscription, count, message_sequence, message_info_sequence, nullptr, nullptr, taken,
+    alloc);
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_set_parallel_take(
+  const rmw_subscription_t * subscription, size_t min_serialized_size)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription handle,
+    subscription->implementation_identifier, eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  CddsSubscription * sub = static_cast<CddsSubscription *>(subscription->data);
+  RET_NULL(sub);
+  sub->parallel_take_min_size.store(min_serialized_size, std::memory_order_relaxed);
+  return RMW_RET_OK;
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_set_take_executor(
+  rmw_cyclonedds_cpp_executor_t executor, void * executor_arg)
+{
+  std::lock_guard<std::mutex> lock(take_executor_lock);
+  take_executor = executor;
+  take_executor_arg = executor_arg;
+  return RMW_RET_OK;
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_take_sequence_with_invalid(
+  const rmw_subscription_t * subscription, size_t count,
+  rmw_message_sequence_t * message_sequence,
+  rmw_message_info_sequence_t * message_info_sequence,
+  rmw_cyclonedds_cpp_invalid_sample_t * invalid_samples, size_t * n_invalid,
+  size_t * taken, rmw_subscription_allocation_t * allocation)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(invalid_samples, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(n_invalid, RMW_RET_INVALID_ARGUMENT);
+  CddsSubscriptionAllocation * alloc = nullptr;
+  if (allocation != nullptr) {
+    RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+      allocation, allocation->implementation_identifier, eclipse_cyclonedds_identifier,
+      return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+    alloc = static_cast<CddsSubscriptionAllocation *>(allocation->data);
+  }
+  return rmw_take_seq(
+    subscription, count, message_sequence, message_info_sequence, invalid_samples, n_invalid,
+    taken, alloc);
 }
 
 extern "C" rmw_ret_t rmw_take_serialized_message(
@@ -3621,6 +4649,60 @@ extern "C" rmw_ret_t rmw_take_serialized_message_with_info(
   return rmw_take_ser_int(subscription, serialized_message, taken, message_info);
 }
 
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_take_cdr_view(
+  const rmw_subscription_t * subscription, rmw_cyclonedds_cpp_cdr_view_t ** view,
+  bool * taken, rmw_message_info_t * message_info)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    view, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    taken, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription handle,
+    subscription->implementation_identifier, eclipse_cyclonedds_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  CddsSubscription * sub = static_cast<CddsSubscription *>(subscription->data);
+  RET_NULL(sub);
+  *taken = false;
+  dds_sample_info_t info;
+  struct ddsi_serdata * d;
+  while (dds_takecdr(sub->enth, &d, 1, &info, DDS_ANY_STATE) == 1) {
+    if (!info.valid_data) {
+      ddsi_serdata_unref(d);
+      continue;
+    }
+    try {
+      /* the view keeps the serdata alive, and with it the data it points into */
+      auto sd = static_cast<serdata_rmw *>(d);
+      serdata_rmw_make_contiguous(sd);
+      auto type = static_cast<const struct sertype_rmw *>(d->type);
+      *view = new rmw_cyclonedds_cpp_cdr_view_t(
+        d, type->cdr_writer->root_value_type(), sd->data(), sd->size());
+    } catch (std::exception & e) {
+      RMW_SET_ERROR_MSG(e.what());
+      ddsi_serdata_unref(d);
+      return RMW_RET_ERROR;
+    }
+    if (message_info) {
+      message_info_from_sample_info(info, message_info);
+    }
+    *taken = true;
+    return RMW_RET_OK;
+  }
+  return RMW_RET_OK;
+}
+
+extern "C" rmw_ret_t rmw_cyclonedds_cpp_return_cdr_view(rmw_cyclonedds_cpp_cdr_view_t * view)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(
+    view, RMW_RET_INVALID_ARGUMENT);
+  ddsi_serdata_unref(view->serdata);
+  delete view;
+  return RMW_RET_OK;
+}
+
 extern "C" rmw_ret_t rmw_take_loaned_message(
   const rmw_subscription_t * subscription,
   void ** loaned_message,
@@ -3648,7 +4730,6 @@ static rmw_ret_t return_loaned_message_from_subscription_int(
   const rmw_subscription_t * subscription,
   void * loaned_message)
 {
-#ifdef DDS_HAS_SHM
   RMW_CHECK_ARGUMENT_FOR_NULL(
     subscription, RMW_RET_INVALID_ARGUMENT);
   if (!subscription->can_loan_messages) {
@@ -3667,21 +4748,35 @@ static rmw_ret_t return_loaned_message_from_subscription_int(
     return RMW_RET_ERROR;
   }
 
+#ifdef DDS_HAS_SHM
   // if the subscription allow loaning
   if (cdds_subscription->is_loaning_available) {
     return fini_and_free_sample(cdds_subscription, loaned_message);
+  }
+#endif
+  struct ddsi_serdata * d;
+  {
+    std::lock_guard<std::mutex> lock(cdds_subscription->loans_lock);
+    auto & loans = cdds_subscription->loans;
+    auto it = std::find_if(
+      loans.begin(), loans.end(),
+      [loaned_message](const std::pair<const void *, struct ddsi_serdata *> & loan) {
+        return loan.first == loaned_message;
+      });
+    if (it == loans.end()) {
+      RMW_SET_ERROR_MSG("message was not loaned from this subscription");
+      return RMW_RET_ERROR;
+    }
+    d = it->second;
+    *it = loans.back();
+    loans.pop_back();
+  }
+  if (d != nullptr) {
+    ddsi_serdata_unref(d);
   } else {
-    RMW_SET_ERROR_MSG("returning loan for a non fixed type is not allowed");
-    return RMW_RET_ERROR;
+    ::operator delete(loaned_message);
   }
   return RMW_RET_OK;
-#else
-  (void) subscription;
-  (void) loaned_message;
-  RMW_SET_ERROR_MSG(
-    "rmw_return_loaned_message_from_subscription not implemented for rmw_cyclonedds_cpp");
-  return RMW_RET_UNSUPPORTED;
-#endif
 }
 
 extern "C" rmw_ret_t rmw_return_loaned_message_from_subscription(
@@ -4369,55 +5464,6 @@ extern "C" rmw_ret_t rmw_wait(
 ///////////                                                                   ///////////
 /////////////////////////////////////////////////////////////////////////////////////////
 
-using get_matched_endpoints_fn_t = dds_return_t (*)(
-  dds_entity_t h,
-  dds_instance_handle_t * xs, size_t nxs);
-using BuiltinTopicEndpoint = std::unique_ptr<dds_builtintopic_endpoint_t,
-    std::function<void (dds_builtintopic_endpoint_t *)>>;
-
-static rmw_ret_t get_matched_endpoints(
-  dds_entity_t h, get_matched_endpoints_fn_t fn, std::vector<dds_instance_handle_t> & res)
-{
-  dds_return_t ret;
-  if ((ret = fn(h, res.data(), res.size())) < 0) {
-    return RMW_RET_ERROR;
-  }
-  while (static_cast<size_t>(ret) >= res.size()) {
-    // 128 is a completely arbitrary margin to reduce the risk of having to retry
-    // when matches are create/deleted in parallel
-    res.resize(static_cast<size_t>(ret) + 128);
-    if ((ret = fn(h, res.data(), res.size())) < 0) {
-      return RMW_RET_ERROR;
-    }
-  }
-  res.resize(static_cast<size_t>(ret));
-  return RMW_RET_OK;
-}
-
-static void free_builtintopic_endpoint(dds_builtintopic_endpoint_t * e)
-{
-  dds_delete_qos(e->qos);
-  dds_free(e->topic_name);
-  dds_free(e->type_name);
-  dds_free(e);
-}
-
-static BuiltinTopicEndpoint get_matched_subscription_data(
-  dds_entity_t writer, dds_instance_handle_t readerih)
-{
-  BuiltinTopicEndpoint ep(dds_get_matched_subscription_data(writer, readerih),
-    free_builtintopic_endpoint);
-  return ep;
-}
-
-static BuiltinTopicEndpoint get_matched_publication_data(
-  dds_entity_t reader, dds_instance_handle_t writerih)
-{
-  BuiltinTopicEndpoint ep(dds_get_matched_publication_data(reader, writerih),
-    free_builtintopic_endpoint);
-  return ep;
-}
-
 static const std::string csid_to_string(const client_service_id_t & id)
 {
   std::ostringstream os;
@@ -4460,6 +5506,7 @@ static rmw_ret_t rmw_take_response_request(
       if (source_timestamp) {
         *source_timestamp = info.source_timestamp;
       }
+      /* the response filter of a client already drops responses to other clients */
       if (srcfilter == 0 || srcfilter == wrap.header.guid) {
         *taken = true;
         return RMW_RET_OK;
@@ -4736,6 +5783,31 @@ static void get_unique_csid(const rmw_node_t * node, client_service_id_t & id)
   }
 }
 
+/* Cyclone's sample filter on the response topic of a client: all clients of a service read the
+   same responses, and this drops those to requests of other clients before they are stored,
+   let alone deserialized.  The request header leads the response, and its guid identifies the
+   writer of the request, i.e., arg, the request writer of the client. */
+static bool response_filter_accepts(const void * sample, void * arg)
+{
+  auto pub = static_cast<const CddsPublisher *>(arg);
+  auto d = static_cast<const serdata_rmw_filter_sample *>(sample)->serdata;
+  if (d == nullptr) {
+    return true;
+  }
+  serdata_rmw_make_contiguous(const_cast<serdata_rmw *>(d));
+  auto data = static_cast<const unsigned char *>(d->data());
+  uint64_t guid;
+  if (d->size() < 4 + sizeof(guid) || data[0] != 0 || data[1] > 1) {
+    /* leave it to deserializing to deal with */
+    return true;
+  }
+  memcpy(&guid, data + 4, sizeof(guid));
+  if ((data[1] == 1) != (native_endian() == endian::little)) {
+    rmw_cyclonedds_cpp::byteswap_copy(&guid, &guid, 1, sizeof(guid));
+  }
+  return guid == pub->pubiid;
+}
+
 static rmw_ret_t rmw_init_cs(
   CddsCS * cs, user_callback_data_t * cb_data,
   const rmw_node_t * node,
@@ -4775,39 +5847,35 @@ static rmw_ret_t rmw_init_cs(
   auto pub = std::make_unique<CddsPublisher>();
   auto sub = std::make_unique<CddsSubscription>();
   std::string subtopic_name, pubtopic_name;
-  void * pub_type_support, * sub_type_support;
   dds_qos_t * pub_qos, * sub_qos;
   const rosidl_type_hash_t * pub_type_hash;
   const rosidl_type_hash_t * sub_type_hash;
   std::string user_data;
 
-  std::unique_ptr<rmw_cyclonedds_cpp::StructValueType> pub_msg_ts, sub_msg_ts;
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> pub_type, sub_type;
+  try {
+    const auto request = rmw_cyclonedds_cpp::TypeRole::Request;
+    const auto response = rmw_cyclonedds_cpp::TypeRole::Response;
+    pub_type = rmw_cyclonedds_cpp::get_registered_service_type(
+      type_support, is_service ? response : request);
+    sub_type = rmw_cyclonedds_cpp::get_registered_service_type(
+      type_support, is_service ? request : response);
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return RMW_RET_ERROR;
+  }
 
   dds_listener_t * listener = dds_create_listener(cb_data);
   dds_lset_data_available_arg(listener, dds_listener_callback, cb_data, false);
 
   if (is_service) {
-    std::tie(sub_msg_ts, pub_msg_ts) =
-      rmw_cyclonedds_cpp::make_request_response_value_types(type_supports);
-
-    sub_type_support = create_request_type_support(
-      type_support->data, type_support->typesupport_identifier);
     sub_type_hash = type_supports->request_typesupport->type_hash;
-    pub_type_support = create_response_type_support(
-      type_support->data, type_support->typesupport_identifier);
     pub_type_hash = type_supports->response_typesupport->type_hash;
     subtopic_name =
       make_fqtopic(ROS_SERVICE_REQUESTER_PREFIX, service_name, "Request", qos_policies);
     pubtopic_name = make_fqtopic(ROS_SERVICE_RESPONSE_PREFIX, service_name, "Reply", qos_policies);
   } else {
-    std::tie(pub_msg_ts, sub_msg_ts) =
-      rmw_cyclonedds_cpp::make_request_response_value_types(type_supports);
-
-    pub_type_support = create_request_type_support(
-      type_support->data, type_support->typesupport_identifier);
     pub_type_hash = type_supports->request_typesupport->type_hash;
-    sub_type_support = create_response_type_support(
-      type_support->data, type_support->typesupport_identifier);
     sub_type_hash = type_supports->response_typesupport->type_hash;
     pubtopic_name =
       make_fqtopic(ROS_SERVICE_REQUESTER_PREFIX, service_name, "Request", qos_policies);
@@ -4824,9 +5892,7 @@ static rmw_ret_t rmw_init_cs(
   dds_entity_t pubtopic, subtopic;
   struct sertype_rmw * pub_st, * sub_st;
 
-  pub_st = create_sertype(
-    type_support->typesupport_identifier, pub_type_support, true,
-    std::move(pub_msg_ts));
+  pub_st = create_sertype(std::move(pub_type));
   struct ddsi_sertype * pub_stact;
   pubtopic = create_topic(node->context->impl->ppant, pubtopic_name.c_str(), pub_st, &pub_stact);
   if (pubtopic < 0) {
@@ -4834,9 +5900,7 @@ static rmw_ret_t rmw_init_cs(
     goto fail_pubtopic;
   }
 
-  sub_st = create_sertype(
-    type_support->typesupport_identifier, sub_type_support, true,
-    std::move(sub_msg_ts));
+  sub_st = create_sertype(std::move(sub_type));
   subtopic = create_topic(node->context->impl->ppant, subtopic_name.c_str(), sub_st);
   if (subtopic < 0) {
     set_error_message_from_create_topic(subtopic, subtopic_name);
@@ -4865,6 +5929,22 @@ static rmw_ret_t rmw_init_cs(
   }
   get_entity_gid(pub->enth, pub->gid);
   pub->sertype = pub_stact;
+  if (dds_get_instance_handle(pub->enth, &pub->pubiid) < 0) {
+    RMW_SET_ERROR_MSG("failed to get instance handle for writer");
+    goto fail_instance_handle;
+  }
+  if (!is_service) {
+    /* before creating the reader, so that it never stores a response meant for someone else;
+       rmw_take_response still checks, but no longer has to skip responses */
+    struct dds_topic_filter response_filter;
+    response_filter.mode = DDS_TOPIC_FILTER_SAMPLE_ARG;
+    response_filter.f.sample_arg = response_filter_accepts;
+    response_filter.arg = pub.get();
+    if (dds_set_topic_filter_extended(subtopic, &response_filter) < 0) {
+      RMW_SET_ERROR_MSG("failed to set response filter");
+      goto fail_instance_handle;
+    }
+  }
   if ((sub->enth =
     dds_create_reader(node->context->impl->dds_sub, subtopic, sub_qos, listener)) < 0)
   {
@@ -4876,25 +5956,21 @@ static rmw_ret_t rmw_init_cs(
     RMW_SET_ERROR_MSG("failed to create readcondition");
     goto fail_readcond;
   }
-  if (dds_get_instance_handle(pub->enth, &pub->pubiid) < 0) {
-    RMW_SET_ERROR_MSG("failed to get instance handle for writer");
-    goto fail_instance_handle;
-  }
   dds_delete_listener(listener);
   dds_delete_qos(pub_qos);
   dds_delete_qos(sub_qos);
-  dds_delete(subtopic);
+  /* the reader's topic holds the response filter */
+  sub->topic = subtopic;
   dds_delete(pubtopic);
 
   cs->pub = std::move(pub);
   cs->sub = std::move(sub);
   return RMW_RET_OK;
 
-fail_instance_handle:
-  dds_delete(sub->rdcondh);
 fail_readcond:
   dds_delete(sub->enth);
 fail_reader:
+fail_instance_handle:
   dds_delete(pub->enth);
 fail_writer:
   dds_delete_qos(sub_qos);
@@ -4912,6 +5988,7 @@ static void rmw_fini_cs(CddsCS * cs)
 {
   dds_delete(cs->sub->rdcondh);
   dds_delete(cs->sub->enth);
+  dds_delete(cs->sub->topic);
   dds_delete(cs->pub->enth);
 }
 
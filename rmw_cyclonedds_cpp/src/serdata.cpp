@@ -13,43 +13,34 @@
 // limitations under the License.
 #include "serdata.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "rmw/allocators.h"
 #include "Serialization.hpp"
 #include "TypeSupport2.hpp"
 #include "bytewise.hpp"
 #include "dds/ddsi/q_radmin.h"
+#include "generated_codecs.hpp"
 #include "rmw/error_handling.h"
 #include "MessageTypeSupport.hpp"
-#include "ServiceTypeSupport.hpp"
+#include "serdata_pool.hpp"
 #include "serdes.hpp"
+#include "type_registry.hpp"
 
-using TypeSupport_c =
-  rmw_cyclonedds_cpp::TypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
-using TypeSupport_cpp =
-  rmw_cyclonedds_cpp::TypeSupport<rosidl_typesupport_introspection_cpp::MessageMembers>;
 using MessageTypeSupport_c =
   rmw_cyclonedds_cpp::MessageTypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
 using MessageTypeSupport_cpp =
   rmw_cyclonedds_cpp::MessageTypeSupport<rosidl_typesupport_introspection_cpp::MessageMembers>;
-using RequestTypeSupport_c = rmw_cyclonedds_cpp::RequestTypeSupport<
-  rosidl_typesupport_introspection_c__ServiceMembers,
-  rosidl_typesupport_introspection_c__MessageMembers>;
-using RequestTypeSupport_cpp = rmw_cyclonedds_cpp::RequestTypeSupport<
-  rosidl_typesupport_introspection_cpp::ServiceMembers,
-  rosidl_typesupport_introspection_cpp::MessageMembers>;
-using ResponseTypeSupport_c = rmw_cyclonedds_cpp::ResponseTypeSupport<
-  rosidl_typesupport_introspection_c__ServiceMembers,
-  rosidl_typesupport_introspection_c__MessageMembers>;
-using ResponseTypeSupport_cpp = rmw_cyclonedds_cpp::ResponseTypeSupport<
-  rosidl_typesupport_introspection_cpp::ServiceMembers,
-  rosidl_typesupport_introspection_cpp::MessageMembers>;
 
 static bool using_introspection_c_typesupport(const char * typesupport_identifier)
 {
@@ -61,55 +52,16 @@ static bool using_introspection_cpp_typesupport(const char * typesupport_identif
   return typesupport_identifier == rosidl_typesupport_introspection_cpp::typesupport_identifier;
 }
 
-void * create_message_type_support(
-  const void * untyped_members,
-  const char * typesupport_identifier)
+static void update_size_hint(std::atomic<size_t> & size_hint, size_t size)
 {
-  if (using_introspection_c_typesupport(typesupport_identifier)) {
-    auto members =
-      static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(untyped_members);
-    return new MessageTypeSupport_c(members);
-  } else if (using_introspection_cpp_typesupport(typesupport_identifier)) {
-    auto members =
-      static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(untyped_members);
-    return new MessageTypeSupport_cpp(members);
+  /* Follow increases immediately but decay slowly, so that the initial capacity nearly always
+     suffices, yet an occasional large message doesn't inflate it forever.  Racing updates are
+     harmless: it is only a hint. */
+  size_t hint = size_hint.load(std::memory_order_relaxed);
+  size_t new_hint = (size >= hint) ? size : hint - (hint - size) / 16;
+  if (new_hint != hint) {
+    size_hint.store(new_hint, std::memory_order_relaxed);
   }
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
-}
-
-void * create_request_type_support(
-  const void * untyped_members,
-  const char * typesupport_identifier)
-{
-  if (using_introspection_c_typesupport(typesupport_identifier)) {
-    auto members =
-      static_cast<const rosidl_typesupport_introspection_c__ServiceMembers *>(untyped_members);
-    return new RequestTypeSupport_c(members);
-  } else if (using_introspection_cpp_typesupport(typesupport_identifier)) {
-    auto members =
-      static_cast<const rosidl_typesupport_introspection_cpp::ServiceMembers *>(untyped_members);
-    return new RequestTypeSupport_cpp(members);
-  }
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
-}
-
-void * create_response_type_support(
-  const void * untyped_members,
-  const char * typesupport_identifier)
-{
-  if (using_introspection_c_typesupport(typesupport_identifier)) {
-    auto members =
-      static_cast<const rosidl_typesupport_introspection_c__ServiceMembers *>(untyped_members);
-    return new ResponseTypeSupport_c(members);
-  } else if (using_introspection_cpp_typesupport(typesupport_identifier)) {
-    auto members =
-      static_cast<const rosidl_typesupport_introspection_cpp::ServiceMembers *>(untyped_members);
-    return new ResponseTypeSupport_cpp(members);
-  }
-  RMW_SET_ERROR_MSG("Unknown typesupport identifier");
-  return nullptr;
 }
 
 static void serialize_into_serdata_rmw(serdata_rmw * d, const void * sample)
@@ -118,18 +70,33 @@ static void serialize_into_serdata_rmw(serdata_rmw * d, const void * sample)
   try {
     if (d->kind != SDK_DATA) {
       /* ROS 2 doesn't do keys, so SDK_KEY is trivial */
-    } else if (!type->is_request_header) {
-      size_t sz = type->cdr_writer->get_serialized_size(sample);
-      d->resize(sz);
+    } else if (type->codec != nullptr) {
+      /* serializer generated for this type, cheap enough to run twice to avoid reallocating */
+      d->resize(
+        type->fixed_serialized_size != 0 ?
+        type->fixed_serialized_size : type->codec->get_serialized_size(sample));
+      type->codec->serialize(sample, d->data());
+    } else if (type->fixed_serialized_size != 0 && !type->is_request_header) {
+      /* fixed-layout type: a single allocation of the known size, and for the simplest types
+         serializing is just copying the sample */
+      d->resize(type->fixed_serialized_size);
       type->cdr_writer->serialize(d->data(), sample);
+    } else if (!type->is_request_header) {
+      /* serialize in a single pass, starting from the expected size (or all of the buffer
+         of a reused serdata) and growing as needed */
+      d->resize(
+        std::max(type->serialized_size_hint.load(std::memory_order_relaxed), d->capacity()));
+      type->cdr_writer->serialize(*d, sample);
+      update_size_hint(type->serialized_size_hint, d->size());
     } else {
       /* inject the service invocation header data into the CDR stream --
        * I haven't checked how it is done in the official RMW implementations, so it is
        * probably incompatible. */
       auto wrap = *static_cast<const cdds_request_wrapper_t *>(sample);
-      size_t sz = type->cdr_writer->get_serialized_size(wrap);
-      d->resize(sz);
-      type->cdr_writer->serialize(d->data(), wrap);
+      d->resize(
+        std::max(type->serialized_size_hint.load(std::memory_order_relaxed), d->capacity()));
+      type->cdr_writer->serialize(*d, wrap);
+      update_size_hint(type->serialized_size_hint, d->size());
     }
   } catch (std::exception & e) {
     RMW_SET_ERROR_MSG(e.what());
@@ -138,31 +105,70 @@ static void serialize_into_serdata_rmw(serdata_rmw * d, const void * sample)
 
 static void serialize_into_serdata_rmw_on_demand(serdata_rmw * d)
 {
+  if (d->has_segments()) {
+    /* a sample being published that is also read, e.g., by a local subscription */
+    d->gather();
+    return;
+  }
 #ifdef DDS_HAS_SHM
-  auto type = const_cast<sertype_rmw *>(static_cast<const sertype_rmw *>(d->type));
-  {
-    std::lock_guard<std::mutex> lock(type->serialize_lock);
-    if (d->iox_chunk && d->data() == nullptr) {
-      auto iox_header = iceoryx_header_from_chunk(d->iox_chunk);
-      // if the iox chunk has the data in serialized form
-      if (iox_header->shm_data_state == IOX_CHUNK_CONTAINS_SERIALIZED_DATA) {
-        d->resize(iox_header->data_size);
-        memcpy(d->data(), d->iox_chunk, iox_header->data_size);
-      } else if (iox_header->shm_data_state == IOX_CHUNK_CONTAINS_RAW_DATA) {
-        serialize_into_serdata_rmw(const_cast<serdata_rmw *>(d), d->iox_chunk);
-      } else {
-        RMW_SET_ERROR_MSG("Received iox chunk is uninitialized");
-      }
+  /* once the data is there, which is checked without locking, this is all it costs */
+  if (!d->begin_serialize()) {
+    return;
+  }
+  try {
+    auto iox_header = iceoryx_header_from_chunk(d->iox_chunk);
+    // if the iox chunk has the data in serialized form
+    if (iox_header->shm_data_state == IOX_CHUNK_CONTAINS_SERIALIZED_DATA) {
+      d->resize(iox_header->data_size);
+      memcpy(d->data(), d->iox_chunk, iox_header->data_size);
+    } else if (iox_header->shm_data_state == IOX_CHUNK_CONTAINS_RAW_DATA) {
+      serialize_into_serdata_rmw(d, d->iox_chunk);
+    } else {
+      RMW_SET_ERROR_MSG("Received iox chunk is uninitialized");
     }
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
   }
+  /* also on failure, or threads waiting for it would never stop waiting */
+  d->end_serialize();
 #endif
   (void)d;
 }
 
+void serdata_rmw_make_contiguous(serdata_rmw * d)
+{
+  serialize_into_serdata_rmw_on_demand(d);
+}
+
+const void * serdata_rmw_sample_in_place(const serdata_rmw * d)
+{
+  auto type = static_cast<const struct sertype_rmw *>(d->type);
+  if (d->kind != SDK_DATA || !type->is_memcpy_serialized || type->is_request_header ||
+    d->has_segments() || d->size() < 4 + type->registered_type->sample_size)
+  {
+    return nullptr;
+  }
+  /* the CDR header followed by the sample, which in memory may have trailing padding that
+     is not serialized */
+  auto header = static_cast<const unsigned char *>(d->data());
+  if (header == nullptr || header[0] != 0 ||
+    header[1] != (native_endian() == endian::little ? 1 : 0))
+  {
+    return nullptr;
+  }
+  const unsigned char * payload = header + 4;
+  if (reinterpret_cast<uintptr_t>(payload) % type->registered_type->memcpy_alignment != 0) {
+    return nullptr;
+  }
+  return payload;
+}
+
 static uint32_t serdata_rmw_size(const struct ddsi_serdata * dcmn)
 {
   auto d = static_cast<const serdata_rmw *>(dcmn);
-  serialize_into_serdata_rmw_on_demand(const_cast<serdata_rmw *>(d));
+  if (!d->has_segments()) {
+    serialize_into_serdata_rmw_on_demand(const_cast<serdata_rmw *>(d));
+  }
   size_t size = d->size();
   uint32_t size_u32 = static_cast<uint32_t>(size);
   assert(size == size_u32);
@@ -179,7 +185,8 @@ static void serdata_rmw_free(struct ddsi_serdata * dcmn)
     d->iox_chunk = nullptr;
   }
 #endif
-  delete d;
+  d->release_segments();
+  rmw_cyclonedds_cpp::release_serdata(d);
 }
 
 static struct ddsi_serdata * serdata_rmw_from_ser(
@@ -188,7 +195,11 @@ static struct ddsi_serdata * serdata_rmw_from_ser(
   const struct nn_rdata * fragchain, size_t size)
 {
   try {
-    auto d = std::make_unique<serdata_rmw>(type, kind);
+    /* The data is copied even if it arrived in a single fragment: referencing it in place would
+       mean keeping the receive buffer alive through a reference to the fragment chain, but
+       libddsc does not export the functions for that.  The serdata and its buffer come from the
+       pool, so the copy is all it costs. */
+    std::unique_ptr<serdata_rmw> d(rmw_cyclonedds_cpp::allocate_serdata(type, kind, size));
     uint32_t off = 0;
     assert(fragchain->min == 0);
     assert(fragchain->maxp1 >= off);    /* CDR header must be in first fragment */
@@ -223,7 +234,7 @@ static struct ddsi_serdata * serdata_rmw_from_ser_iov(
   size_t size)
 {
   try {
-    auto d = std::make_unique<serdata_rmw>(type, kind);
+    std::unique_ptr<serdata_rmw> d(rmw_cyclonedds_cpp::allocate_serdata(type, kind, size));
     d->resize(size);
 
     auto cursor = d->data();
@@ -244,7 +255,7 @@ static struct ddsi_serdata * serdata_rmw_from_keyhash(
 {
   static_cast<void>(keyhash);    // unused
   /* there is no key field, so from_keyhash is trivial */
-  return new serdata_rmw(type, SDK_KEY);
+  return rmw_cyclonedds_cpp::allocate_serdata(type, SDK_KEY, 0);
 }
 
 static struct ddsi_serdata * serdata_rmw_from_sample(
@@ -254,7 +265,14 @@ static struct ddsi_serdata * serdata_rmw_from_sample(
 {
   try {
     const struct sertype_rmw * type = static_cast<const struct sertype_rmw *>(typecmn);
-    auto d = std::make_unique<serdata_rmw>(type, kind);
+    /* a pooled serdata with a buffer of about the right size, that serializing fills without
+       having to reallocate in the common case */
+    size_t capacity = 0;
+    if (kind == SDK_DATA) {
+      capacity = (type->fixed_serialized_size != 0) ?
+        type->fixed_serialized_size : type->serialized_size_hint.load(std::memory_order_relaxed);
+    }
+    std::unique_ptr<serdata_rmw> d(rmw_cyclonedds_cpp::allocate_serdata(type, kind, capacity));
     serialize_into_serdata_rmw(d.get(), sample);
     return d.release();
   } catch (std::exception & e) {
@@ -263,6 +281,59 @@ static struct ddsi_serdata * serdata_rmw_from_sample(
   }
 }
 
+struct ddsi_serdata * serdata_rmw_from_sample_by_reference(
+  const struct ddsi_sertype * typecmn, const void * sample)
+{
+  const struct sertype_rmw * type = static_cast<const struct sertype_rmw *>(typecmn);
+  /* nothing gets referenced in messages smaller than min_referenced_size, and messages tend to
+     be of a similar size as the recent ones */
+  if (!type->serialize_by_reference ||
+    type->serialized_size_hint.load(std::memory_order_relaxed) <
+    rmw_cyclonedds_cpp::min_referenced_size)
+  {
+    return serdata_rmw_from_sample(type, SDK_DATA, sample);
+  }
+  try {
+    /* the buffer of the serdata only holds what isn't referenced */
+    std::unique_ptr<serdata_rmw> d(
+      rmw_cyclonedds_cpp::allocate_serdata(
+        type, SDK_DATA, type->unreferenced_size_hint.load(std::memory_order_relaxed)));
+    std::vector<serdata_rmw_segment> segments;
+    d->resize(d->capacity());
+    type->cdr_writer->serialize(*d, segments, sample);
+    update_size_hint(type->unreferenced_size_hint, d->size());
+    if (!segments.empty()) {
+      d->set_segments(std::move(segments));
+    }
+    update_size_hint(type->serialized_size_hint, d->size());
+    return d.release();
+  } catch (std::exception & e) {
+    RMW_SET_ERROR_MSG(e.what());
+    return nullptr;
+  }
+}
+
+bool serdata_rmw_unreference_sample(struct ddsi_serdata * dcmn)
+{
+  auto d = static_cast<serdata_rmw *>(dcmn);
+  if (!d->has_segments()) {
+    return true;
+  }
+  if (ddsrt_atomic_ld32(&d->refc) == 1) {
+    /* the caller's is the only reference, so no one will ever look at the data again */
+    return true;
+  }
+  return d->drop_references();
+}
+
+void serdata_rmw_detach_sample(struct ddsi_serdata * dcmn)
+{
+  auto d = static_cast<serdata_rmw *>(dcmn);
+  if (d->has_segments()) {
+    d->forget_references();
+  }
+}
+
 #ifdef DDS_HAS_SHM
 static struct ddsi_serdata * serdata_rmw_from_iox(
   const struct ddsi_sertype * typecmn,
@@ -270,9 +341,10 @@ static struct ddsi_serdata * serdata_rmw_from_iox(
 {
   try {
     const struct sertype_rmw * type = static_cast<const struct sertype_rmw *>(typecmn);
-    auto d = std::make_unique<serdata_rmw>(type, kind);
+    std::unique_ptr<serdata_rmw> d(rmw_cyclonedds_cpp::allocate_serdata(type, kind, 0));
     d->iox_chunk = iox_buffer;
     d->iox_subscriber = sub;
+    d->defer_serialize();
     return d.release();
   } catch (std::exception & e) {
     RMW_SET_ERROR_MSG(e.what());
@@ -310,6 +382,10 @@ static struct ddsi_serdata * serdata_rmw_to_untyped(const struct ddsi_serdata *
 static void serdata_rmw_to_ser(const struct ddsi_serdata * dcmn, size_t off, size_t sz, void * buf)
 {
   auto d = static_cast<const serdata_rmw *>(dcmn);
+  if (d->has_segments()) {
+    d->to_ser(off, sz, buf);
+    return;
+  }
   serialize_into_serdata_rmw_on_demand(const_cast<serdata_rmw *>(d));
   memcpy(buf, byte_offset(d->data(), off), sz);
 }
@@ -319,6 +395,10 @@ static struct ddsi_serdata * serdata_rmw_to_ser_ref(
   size_t sz, ddsrt_iovec_t * ref)
 {
   auto d = static_cast<const serdata_rmw *>(dcmn);
+  if (d->has_segments()) {
+    d->to_ser_ref(off, sz, ref);
+    return ddsi_serdata_ref(d);
+  }
   serialize_into_serdata_rmw_on_demand(const_cast<serdata_rmw *>(d));
   ref->iov_base = byte_offset(d->data(), off);
   ref->iov_len = (ddsrt_iov_len_t) sz;
@@ -327,14 +407,25 @@ static struct ddsi_serdata * serdata_rmw_to_ser_ref(
 
 static void serdata_rmw_to_ser_unref(struct ddsi_serdata * dcmn, const ddsrt_iovec_t * ref)
 {
-  static_cast<void>(ref);    // unused
-  ddsi_serdata_unref(static_cast<serdata_rmw *>(dcmn));
+  auto d = static_cast<serdata_rmw *>(dcmn);
+  if (d->has_segments()) {
+    d->to_ser_unref(ref);
+  }
+  ddsi_serdata_unref(d);
 }
 
+/* The one sample a content filter evaluates at a time on a thread, see
+   serdata_rmw_filter_sample */
+static thread_local serdata_rmw_filter_sample filter_sample;
+
 static bool serdata_rmw_to_sample(
   const struct ddsi_serdata * dcmn, void * sample, void ** bufptr,
   void * buflim)
 {
+  if (sample == &filter_sample) {
+    filter_sample.serdata = static_cast<const serdata_rmw *>(dcmn);
+    return true;
+  }
   try {
     static_cast<void>(bufptr);    // unused
     static_cast<void>(buflim);    // unused
@@ -348,6 +439,13 @@ static bool serdata_rmw_to_sample(
     assert(buflim == NULL);
     if (d->kind != SDK_DATA) {
       /* ROS 2 doesn't do keys in a meaningful way yet */
+    } else if (type->codec != nullptr) {
+      serialize_into_serdata_rmw_on_demand(const_cast<serdata_rmw *>(d));
+      if (!type->codec->deserialize(d->data(), d->size(), sample)) {
+        RMW_SET_ERROR_MSG("invalid serialized data");
+        return false;
+      }
+      return true;
     } else if (!type->is_request_header) {
       serialize_into_serdata_rmw_on_demand(const_cast<serdata_rmw *>(d));
       cycdeser sd(d->data(), d->size());
@@ -505,15 +603,7 @@ static void sertype_rmw_free(struct ddsi_sertype * tpcmn)
 #else
   ddsi_sertopic_fini(tpcmn);
 #endif
-  if (tp->type_support.type_support_) {
-    if (using_introspection_c_typesupport(tp->type_support.typesupport_identifier_)) {
-      delete static_cast<TypeSupport_c *>(tp->type_support.type_support_);
-    } else if (using_introspection_cpp_typesupport(tp->type_support.typesupport_identifier_)) {
-      delete static_cast<TypeSupport_cpp *>(tp->type_support.type_support_);
-    }
-    tp->type_support.type_support_ = NULL;
-  }
-
+  /* drops the reference to the registered type, which goes with it if this was the last one */
   delete tp;
 }
 
@@ -529,14 +619,14 @@ static void sertype_rmw_realloc_samples(
   void ** ptrs, const struct ddsi_sertype * d, void * old,
   size_t oldcount, size_t count)
 {
-  static_cast<void>(ptrs);
   static_cast<void>(d);
-  static_cast<void>(old);
-  static_cast<void>(oldcount);
-  static_cast<void>(count);
-  /* Not using code paths that rely on this (loans, dispose, unregister with instance handle,
-     content filters) */
-  abort();
+  /* Not using code paths that rely on this (loans, dispose, unregister with instance handle),
+     except for content filters, which evaluate a single sample */
+  if (old != nullptr || oldcount != 0 || count != 1) {
+    abort();
+  }
+  filter_sample.serdata = nullptr;
+  ptrs[0] = &filter_sample;
 }
 
 static void sertype_rmw_free_samples(
@@ -544,10 +634,12 @@ static void sertype_rmw_free_samples(
   dds_free_op_t op)
 {
   static_cast<void>(d);    // unused
-  static_cast<void>(ptrs);    // unused
   static_cast<void>(count);    // unused
-  /* Not using code paths that rely on this (dispose, unregister with instance handle, content
-     filters) */
+  if (ptrs[0] == &filter_sample) {
+    filter_sample.serdata = nullptr;
+    return;
+  }
+  /* Not using code paths that rely on this (dispose, unregister with instance handle) */
   assert(!(op & DDS_FREE_ALL_BIT));
   (void) op;
 }
@@ -588,7 +680,11 @@ size_t sertype_get_serialized_size(const struct ddsi_sertype * d, const void * s
   size_t serialized_size = 0;
   try {
     // ROS 2 doesn't support keys yet, so only data is handled
-    if (!type->is_request_header) {
+    if (type->fixed_serialized_size != 0 && !type->is_request_header) {
+      serialized_size = type->fixed_serialized_size;
+    } else if (type->codec != nullptr) {
+      serialized_size = type->codec->get_serialized_size(sample);
+    } else if (!type->is_request_header) {
       serialized_size = type->cdr_writer->get_serialized_size(sample);
     } else {
       // inject the service invocation header data into the CDR stream
@@ -613,7 +709,9 @@ bool sertype_serialize_into(
     // ignore destination size (assuming that the destination buffer is resized before correctly)
     static_cast<void>(dst_size);
     // ROS 2 doesn't support keys, so its all data (?)
-    if (!type->is_request_header) {
+    if (type->codec != nullptr) {
+      type->codec->serialize(sample, dst_buffer);
+    } else if (!type->is_request_header) {
       type->cdr_writer->serialize(dst_buffer, sample);
     } else {
       /* inject the service invocation header data into the CDR stream --
@@ -672,65 +770,77 @@ inline std::string create_type_name(const void * untyped_members)
   return ss.str();
 }
 
-static std::string get_type_name(const char * type_support_identifier, void * type_support)
-{
-  if (using_introspection_c_typesupport(type_support_identifier)) {
-    auto typed_typesupport = static_cast<MessageTypeSupport_c *>(type_support);
-    return typed_typesupport->getName();
-  } else if (using_introspection_cpp_typesupport(type_support_identifier)) {
-    auto typed_typesupport = static_cast<MessageTypeSupport_cpp *>(type_support);
-    return typed_typesupport->getName();
-  } else {
-    return "absent";
-  }
-}
-
 struct sertype_rmw * create_sertype(
-  const char * type_support_identifier,
-  void * type_support, bool is_request_header,
-  std::unique_ptr<rmw_cyclonedds_cpp::StructValueType> message_type,
-  const uint32_t sample_size, const bool is_fixed_type)
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> registered_type)
 {
   struct sertype_rmw * st = new struct sertype_rmw;
-  std::string type_name = get_type_name(type_support_identifier, type_support);
+  const bool is_request_header =
+    registered_type->role != rmw_cyclonedds_cpp::TypeRole::Message;
   uint32_t flags = DDSI_SERTYPE_FLAG_TOPICKIND_NO_KEY;
-  if (is_fixed_type) {
+  if (registered_type->is_fixed_type) {
     flags |= DDSI_SERTYPE_FLAG_FIXED_SIZE;
   }
   ddsi_sertype_init_flags(
     static_cast<struct ddsi_sertype *>(st),
-    type_name.c_str(), &sertype_rmw_ops, &serdata_rmw_ops, flags);
+    registered_type->type_name.c_str(), &sertype_rmw_ops, &serdata_rmw_ops, flags);
   st->allowed_data_representation = DDS_DATA_REPRESENTATION_FLAG_XCDR1;
 #ifdef DDS_HAS_SHM
   // TODO(Sumanth) needs some API in cyclone to set this
-  st->iox_size = sample_size;
-#else
-  static_cast<void>(sample_size);
+  st->iox_size = registered_type->sample_size;
 #endif  // DDS_HAS_SHM
-  st->type_support.typesupport_identifier_ = type_support_identifier;
-  st->type_support.type_support_ = type_support;
+  st->type_support.typesupport_identifier_ = registered_type->typesupport_identifier;
+  st->type_support.type_support_ = registered_type->type_support;
   st->is_request_header = is_request_header;
-  st->cdr_writer = rmw_cyclonedds_cpp::make_cdr_writer(std::move(message_type));
+  st->cdr_writer = registered_type->writer.get();
+  st->serialized_size_hint = 0;
+  st->unreferenced_size_hint = 0;
+  st->is_fixed = registered_type->is_fixed_type;
+  st->fixed_serialized_size = registered_type->fixed_serialized_size;
+  st->is_memcpy_serialized = registered_type->is_memcpy_serialized;
+  st->codec = registered_type->codec;
+  st->serialize_by_reference = registered_type->serialize_by_reference;
+  st->registered_type = std::move(registered_type);
 
   return st;
 }
 
-void serdata_rmw::resize(size_t requested_size)
+/* what new returns is aligned for any type, and the buffer starts this far into it */
+static constexpr size_t serdata_buffer_offset = alignof(std::max_align_t) - 4;
+
+void serdata_buffer_deleter::operator()(byte * p) const
 {
-  if (!requested_size) {
-    m_size = 0;
-    m_data.reset();
-    return;
+  delete[] (p - serdata_buffer_offset);
+}
+
+serdata_buffer allocate_serdata_buffer(size_t size)
+{
+  return serdata_buffer(new byte[serdata_buffer_offset + size] + serdata_buffer_offset);
+}
+
+void serdata_rmw::reserve(size_t capacity)
+{
+  if (capacity > m_capacity) {
+    serdata_buffer new_data = allocate_serdata_buffer(capacity);
+    if (m_size > 0) {
+      std::memcpy(new_data.get(), m_data.get(), m_size);
+    }
+    m_data = std::move(new_data);
+    m_capacity = capacity;
   }
+}
 
+void serdata_rmw::resize(size_t requested_size)
+{
   /* FIXME: CDR padding in DDSI makes me do this to avoid reading beyond the bounds
   when copying data to network.  Should fix Cyclone to handle that more elegantly.  */
   size_t n_pad_bytes = (0 - requested_size) % 4;
-  m_data.reset(new byte[requested_size + n_pad_bytes]);
+  reserve(requested_size + n_pad_bytes);
   m_size = requested_size + n_pad_bytes;
 
   // zero the very end. The caller isn't necessarily going to overwrite it.
-  std::memset(byte_offset(m_data.get(), requested_size), '\0', n_pad_bytes);
+  if (n_pad_bytes > 0) {
+    std::memset(byte_offset(m_data.get(), requested_size), '\0', n_pad_bytes);
+  }
 }
 
 serdata_rmw::serdata_rmw(const ddsi_sertype * type, ddsi_serdata_kind kind)
@@ -738,3 +848,224 @@ serdata_rmw::serdata_rmw(const ddsi_sertype * type, ddsi_serdata_kind kind)
 {
   ddsi_serdata_init(this, type, kind);
 }
+
+serdata_rmw::serdata_rmw()
+: ddsi_serdata{}
+{
+}
+
+struct serdata_rmw_segments
+{
+  std::mutex lock;
+  std::vector<serdata_rmw_segment> segments;
+  /* own buffer of the serdata holding the bytes between the referenced data; kept after
+     gathering because to_ser_ref may have handed out pointers into it */
+  serdata_buffer own_data;
+  size_t own_capacity;
+  bool gathered {false};
+  /* number of pointers into referenced data handed out by to_ser_ref and not yet returned */
+  size_t n_references_out {0};
+  /* copies of ranges requested by to_ser_ref that span segments */
+  std::vector<std::unique_ptr<byte[]>> bounce_buffers;
+};
+
+serdata_rmw::~serdata_rmw() = default;
+
+void serdata_rmw::set_segments(std::vector<serdata_rmw_segment> segments)
+{
+  assert(m_segments == nullptr);
+  auto sg = std::make_unique<serdata_rmw_segments>();
+  size_t size = 0;
+  for (const auto & segment : segments) {
+    size += segment.size;
+  }
+  sg->segments = std::move(segments);
+  sg->own_data = std::move(m_data);
+  sg->own_capacity = m_capacity;
+  m_capacity = 0;
+  m_size = size;
+  m_segments = std::move(sg);
+}
+
+void serdata_rmw::gather()
+{
+  std::lock_guard<std::mutex> lock(m_segments->lock);
+  if (m_segments->gathered) {
+    return;
+  }
+  serdata_buffer data = allocate_serdata_buffer(m_size);
+  const byte * own = m_segments->own_data.get();
+  byte * cursor = data.get();
+  for (const auto & segment : m_segments->segments) {
+    const void * src = segment.data ? segment.data : own;
+    std::memcpy(cursor, src, segment.size);
+    cursor += segment.size;
+    if (!segment.data) {
+      own += segment.size;
+    }
+  }
+  /* m_data is only read once gathered is set, and it is not changed afterward */
+  m_data = std::move(data);
+  m_capacity = m_size;
+  m_segments->gathered = true;
+}
+
+bool serdata_rmw::drop_references()
+{
+  gather();
+  std::lock_guard<std::mutex> lock(m_segments->lock);
+  if (m_segments->n_references_out > 0) {
+    return false;
+  }
+  /* from now on to_ser_ref only hands out pointers into the gathered data, and to_ser_unref
+     must no longer compare pointers with memory that may since have been reused */
+  m_segments->segments.clear();
+  return true;
+}
+
+void serdata_rmw::forget_references()
+{
+  gather();
+  std::lock_guard<std::mutex> lock(m_segments->lock);
+  /* to_ser_unref ignores the pointers that are still out once there are no segments */
+  m_segments->n_references_out = 0;
+  m_segments->segments.clear();
+}
+
+void serdata_rmw::release_segments()
+{
+  if (m_segments == nullptr) {
+    return;
+  }
+  assert(m_segments->n_references_out == 0);
+  if (!m_segments->gathered) {
+    m_data = std::move(m_segments->own_data);
+    m_capacity = m_segments->own_capacity;
+  }
+  m_size = 0;
+  m_segments.reset();
+}
+
+void serdata_rmw::to_ser(size_t off, size_t sz, void * buf) const
+{
+  std::lock_guard<std::mutex> lock(m_segments->lock);
+  if (m_segments->gathered) {
+    std::memcpy(buf, byte_offset(m_data.get(), off), sz);
+    return;
+  }
+  const byte * own = m_segments->own_data.get();
+  size_t pos = 0;
+  for (const auto & segment : m_segments->segments) {
+    if (sz == 0) {
+      break;
+    }
+    if (off < pos + segment.size) {
+      const void * src = segment.data ? segment.data : own;
+      size_t n = std::min(sz, pos + segment.size - off);
+      std::memcpy(buf, byte_offset(src, off - pos), n);
+      buf = byte_offset(buf, n);
+      off += n;
+      sz -= n;
+    }
+    pos += segment.size;
+    if (!segment.data) {
+      own += segment.size;
+    }
+  }
+  assert(sz == 0);
+}
+
+void serdata_rmw::to_ser_ref(size_t off, size_t sz, ddsrt_iovec_t * ref) const
+{
+  ref->iov_len = static_cast<ddsrt_iov_len_t>(sz);
+  {
+    std::lock_guard<std::mutex> lock(m_segments->lock);
+    if (m_segments->gathered) {
+      ref->iov_base = byte_offset(m_data.get(), off);
+      return;
+    }
+    const byte * own = m_segments->own_data.get();
+    size_t pos = 0;
+    for (const auto & segment : m_segments->segments) {
+      if (off >= pos && off + sz <= pos + segment.size) {
+        /* all of it in a single segment, which is the common case */
+        const void * src = segment.data ? segment.data : own;
+        ref->iov_base = const_cast<void *>(byte_offset(src, off - pos));
+        if (segment.data) {
+          m_segments->n_references_out++;
+        }
+        return;
+      }
+      pos += segment.size;
+      if (!segment.data) {
+        own += segment.size;
+      }
+    }
+  }
+  std::unique_ptr<byte[]> copy(new byte[sz]);
+  to_ser(off, sz, copy.get());
+  ref->iov_base = copy.get();
+  std::lock_guard<std::mutex> lock(m_segments->lock);
+  m_segments->bounce_buffers.push_back(std::move(copy));
+}
+
+void serdata_rmw::to_ser_unref(const ddsrt_iovec_t * ref) const
+{
+  std::lock_guard<std::mutex> lock(m_segments->lock);
+  auto & bounce_buffers = m_segments->bounce_buffers;
+  for (auto it = bounce_buffers.begin(); it != bounce_buffers.end(); ++it) {
+    if (it->get() == ref->iov_base) {
+      bounce_buffers.erase(it);
+      return;
+    }
+  }
+  for (const auto & segment : m_segments->segments) {
+    auto p = reinterpret_cast<uintptr_t>(ref->iov_base);
+    auto start = reinterpret_cast<uintptr_t>(segment.data);
+    if (segment.data && p >= start && p < start + segment.size) {
+      assert(m_segments->n_references_out > 0);
+      m_segments->n_references_out--;
+      return;
+    }
+  }
+}
+
+void serdata_rmw::defer_serialize()
+{
+  m_serialize_state.store(SERIALIZE_PENDING, std::memory_order_relaxed);
+}
+
+bool serdata_rmw::begin_serialize()
+{
+  uint8_t state = m_serialize_state.load(std::memory_order_acquire);
+  while (state != SERIALIZED) {
+    if (state == SERIALIZE_IN_PROGRESS) {
+      /* serializing a sample is quick, it isn't worth blocking */
+      std::this_thread::yield();
+      state = m_serialize_state.load(std::memory_order_acquire);
+    } else if (m_serialize_state.compare_exchange_weak(
+        state, SERIALIZE_IN_PROGRESS, std::memory_order_acquire, std::memory_order_acquire))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void serdata_rmw::end_serialize()
+{
+  m_serialize_state.store(SERIALIZED, std::memory_order_release);
+}
+
+void serdata_rmw::reset_serialize_state()
+{
+  m_serialize_state.store(SERIALIZED, std::memory_order_relaxed);
+}
+
+void serdata_rmw_reuse_from_sample(
+  serdata_rmw * d, const struct ddsi_sertype * type, const void * sample)
+{
+  assert(d->ops == nullptr || ddsrt_atomic_ld32(&d->refc) == 1);
+  ddsi_serdata_init(d, type, SDK_DATA);
+  serialize_into_serdata_rmw(d, sample);
+}
@@ -14,9 +14,10 @@
 #ifndef SERDATA_HPP_
 #define SERDATA_HPP_
 
+#include <atomic>
 #include <memory>
 #include <string>
-#include <mutex>
+#include <vector>
 
 #include "TypeSupport2.hpp"
 #include "bytewise.hpp"
@@ -38,6 +39,8 @@ extern "C" {
 namespace rmw_cyclonedds_cpp
 {
 class BaseCDRWriter;
+struct GeneratedCodec;
+struct RegisteredType;
 }
 
 struct CddsTypeSupport
@@ -48,26 +51,122 @@ struct CddsTypeSupport
 
 struct sertype_rmw : ddsi_sertype
 {
+  /* shared with all other sertypes for the same type, owns type_support and cdr_writer */
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> registered_type;
   CddsTypeSupport type_support;
   bool is_request_header;
-  std::unique_ptr<const rmw_cyclonedds_cpp::BaseCDRWriter> cdr_writer;
+  const rmw_cyclonedds_cpp::BaseCDRWriter * cdr_writer;
+  /* running estimate of the serialized size, used as the initial capacity when serializing */
+  mutable std::atomic<size_t> serialized_size_hint;
+  /* same for the part of it that isn't referenced when serializing by reference */
+  mutable std::atomic<size_t> unreferenced_size_hint;
   bool is_fixed;
-  std::mutex serialize_lock;
+  /* serialized size of every sample if it doesn't depend on the contents, 0 otherwise */
+  size_t fixed_serialized_size;
+  /* samples are serialized as the CDR header followed by a verbatim copy of the sample */
+  bool is_memcpy_serialized;
+  /* type-specialised serializer generated at build time, used instead of cdr_writer and the
+     introspection typesupport if available */
+  const rmw_cyclonedds_cpp::GeneratedCodec * codec;
+  /* publishing references large arrays in the sample rather than copying them, see
+     serdata_rmw_from_sample_by_reference */
+  bool serialize_by_reference;
 };
 
+/* A piece of serialized data: `size` bytes at `data`, or, if data is a null pointer, the next
+   `size` bytes in the serdata's own buffer */
+struct serdata_rmw_segment
+{
+  const void * data;
+  size_t size;
+};
+
+struct serdata_rmw_segments;
+
+/* A buffer for serialized data, allocated such that what follows the 4-byte CDR header is
+   aligned for any type, which is what it takes for a sample that is serialized as a verbatim
+   copy to be usable in place (see serdata_rmw_sample_in_place) */
+struct serdata_buffer_deleter
+{
+  void operator()(byte * p) const;
+};
+using serdata_buffer = std::unique_ptr<byte[], serdata_buffer_deleter>;
+serdata_buffer allocate_serdata_buffer(size_t size);
+
 class serdata_rmw : public ddsi_serdata
 {
 protected:
   size_t m_size {0};
+  size_t m_capacity {0};
   /* first two bytes of data is CDR encoding
      second two bytes are encoding options */
-  std::unique_ptr<byte[]> m_data {nullptr};
+  serdata_buffer m_data {nullptr};
+  /* serialized data that references memory of the sample it was serialized from, its own
+     buffer then only holding the bytes in between */
+  std::unique_ptr<serdata_rmw_segments> m_segments;
+  /* whether data() holds the serialized sample, see begin_serialize */
+  enum serialize_state : uint8_t
+  {
+    SERIALIZED,
+    SERIALIZE_PENDING,
+    SERIALIZE_IN_PROGRESS
+  };
+  std::atomic<uint8_t> m_serialize_state {SERIALIZED};
 
 public:
   serdata_rmw(const ddsi_sertype * type, ddsi_serdata_kind kind);
+  /* not yet initialized as a serdata, see serdata_rmw_reuse_from_sample */
+  serdata_rmw();
+  ~serdata_rmw();
+  serdata_rmw(const serdata_rmw &) = delete;
+  serdata_rmw & operator=(const serdata_rmw &) = delete;
+  /* like std::vector::resize: existing contents are preserved and the buffer is only
+     reallocated if it lacks the capacity */
   void resize(size_t requested_size);
+  void reserve(size_t capacity);
   size_t size() const {return m_size;}
+  size_t capacity() const {return m_capacity;}
   void * data() const {return m_data.get();}
+
+  /* Make the data consist of `segments`, interleaving the bytes now in the buffer with data
+     referenced in place */
+  void set_segments(std::vector<serdata_rmw_segment> segments);
+  bool has_segments() const {return m_segments != nullptr;}
+  /* Copy data referenced by segments into a buffer of its own, so that data() can be used.
+     Must be done while the referenced memory is still valid. */
+  void gather();
+  /* Gather the data and forget about the referenced memory, unless to_ser_ref handed out
+     pointers into it that haven't been returned yet, in which case it returns false */
+  bool drop_references();
+  /* Gather the data and forget about the referenced memory even if to_ser_ref handed out
+     pointers into it, which are then no longer tracked */
+  void forget_references();
+  /* revert to plain contiguous data, leaving the serdata empty */
+  void release_segments();
+
+  /* data() holds the serialized sample, except for a sample that starts out only in a
+     shared-memory chunk: defer_serialize marks it as such, and data() is then filled in when
+     it is first needed, exactly once even if several threads need it at the same time.  The
+     one thread for which begin_serialize returns true must fill it in and then call
+     end_serialize; begin_serialize returns false once data() is there, waiting for it if
+     another thread is busy filling it in, which costs a single load in the common case. */
+  void defer_serialize();
+  bool begin_serialize();
+  void end_serialize();
+  /* for a serdata that is being recycled */
+  void reset_serialize_state();
+  void to_ser(size_t off, size_t sz, void * buf) const;
+  void to_ser_ref(size_t off, size_t sz, ddsrt_iovec_t * ref) const;
+  void to_ser_unref(const ddsrt_iovec_t * ref) const;
+};
+
+/* What a content filter installed on a reader (dds_set_topic_filter_extended) gets as the
+   sample: Cyclone "deserializes" the data into a sample it allocates with the sertype, which
+   for the sertype_rmw only records the serdata, so that the filter can work on the serialized
+   data instead */
+struct serdata_rmw_filter_sample
+{
+  const serdata_rmw * serdata;
 };
 
 typedef struct cdds_request_header
@@ -82,22 +181,43 @@ typedef struct cdds_request_wrapper
   void * data;
 } cdds_request_wrapper_t;
 
-void * create_message_type_support(
-  const void * untyped_members,
-  const char * typesupport_identifier);
-void * create_request_type_support(
-  const void * untyped_members,
-  const char * typesupport_identifier);
-void * create_response_type_support(
-  const void * untyped_members,
-  const char * typesupport_identifier);
-
+/* Create a sertype for a type from the type registry, requests and responses getting a
+   request header */
 struct sertype_rmw * create_sertype(
-  const char * type_support_identifier,
-  void * type_support, bool is_request_header,
-  std::unique_ptr<rmw_cyclonedds_cpp::StructValueType> message_type_support,
-  const uint32_t sample_size = 0U,
-  const bool is_fixed_type = false);
+  std::shared_ptr<const rmw_cyclonedds_cpp::RegisteredType> registered_type);
+
+/* Serialize a sample into an existing serdata, keeping its buffer, and (re)initialize it as
+   a data sample of the given type with a reference count of 1.  No one else may hold a
+   reference to it. */
+void serdata_rmw_reuse_from_sample(
+  serdata_rmw * d, const struct ddsi_sertype * type, const void * sample);
+
+/* Serialize a sample for publishing it with dds_writecdr, referencing large arrays in the sample
+   instead of copying them if the type allows it and recent samples were large enough for it to
+   pay.  The sample must not change until serdata_rmw_unreference_sample returns true. */
+struct ddsi_serdata * serdata_rmw_from_sample_by_reference(
+  const struct ddsi_sertype * type, const void * sample);
+
+/* Make a serdata returned by serdata_rmw_from_sample_by_reference independent of the sample,
+   copying the data it references if anyone else still has a reference to it.  Returns false
+   if data handed out for transmitting may still point into the sample, in which case it must
+   be called again after flushing the writer. */
+bool serdata_rmw_unreference_sample(struct ddsi_serdata * d);
+
+/* Make a serdata returned by serdata_rmw_from_sample_by_reference independent of the sample
+   like serdata_rmw_unreference_sample, but without waiting for data handed out for transmitting
+   to be returned.  Only for once the writer has been flushed, after which nothing that is still
+   being transmitted points into the sample. */
+void serdata_rmw_detach_sample(struct ddsi_serdata * d);
+
+/* Make the serialized data of a sample available through data(), which it isn't yet for
+   samples received through shared memory or published by reference */
+void serdata_rmw_make_contiguous(serdata_rmw * d);
+
+/* For a type that is serialized as a verbatim copy of the sample, the sample in the serialized
+   data of a contiguous serdata if it can be used in place, a null pointer if it can't, e.g.,
+   because it is in the other byte order or not suitably aligned */
+const void * serdata_rmw_sample_in_place(const serdata_rmw * d);
 
 struct ddsi_serdata * serdata_rmw_from_serialized_message(
   const struct ddsi_sertype * typecmn,
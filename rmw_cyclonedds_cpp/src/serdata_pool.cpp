@@ -0,0 +1,168 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "serdata_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+/* A serdata does not keep its sertype alive and may have no type at all (see to_untyped), so
+   the pool is process-wide rather than per type, like the serdata pool of Cyclone itself.  That
+   also lets the types in a process share what is retained: what a serdata is worth recycling
+   for is its buffer, and buffers are interchangeable between types of similar sizes, whereas
+   per-type pools would each retain their own buffers for types that are rarely used.
+
+   Nor are there per-thread caches: samples are typically allocated by the receive thread and
+   freed by the application, so a cache of the freeing thread would only fill up while that of
+   the allocating thread stays empty.
+
+   Serdata are kept in size classes by the capacity of their buffer: class k holds those with a
+   capacity of at least 2^(min_class_log2 + k) bytes, which is also what a new one gets.  Each
+   class is split in stripes with their own lock, and threads start at different stripes, so
+   that threads rarely contend.  Samples are typically allocated by the receive thread and freed
+   by the application, so allocating looks at the other stripes before giving up. */
+constexpr size_t min_class_log2 = 6;
+constexpr size_t n_classes = 11;    /* up to 64kB, larger buffers aren't retained */
+constexpr size_t n_stripes = 8;
+constexpr size_t retained_bytes_per_class = 1024 * 1024;
+
+struct Stripe
+{
+  std::mutex lock;
+  std::vector<serdata_rmw *> free;
+};
+
+struct SizeClass
+{
+  size_t max_per_stripe;
+  std::array<Stripe, n_stripes> stripes;
+};
+
+/* Leaked rather than destroyed: serdata may still be freed while the process is exiting. */
+struct SerdataPool
+{
+  SerdataPool()
+  {
+    for (size_t k = 0; k < n_classes; k++) {
+      size_t class_size = size_t{1} << (min_class_log2 + k);
+      classes[k].max_per_stripe =
+        std::max(size_t{2}, retained_bytes_per_class / class_size / n_stripes);
+      for (auto & stripe : classes[k].stripes) {
+        stripe.free.reserve(classes[k].max_per_stripe);
+      }
+    }
+  }
+
+  std::array<SizeClass, n_classes> classes;
+  std::atomic<size_t> next_stripe {0};
+};
+
+SerdataPool & get_pool()
+{
+  static SerdataPool * pool = new SerdataPool;
+  return *pool;
+}
+
+size_t home_stripe(SerdataPool & pool)
+{
+  thread_local size_t stripe = pool.next_stripe++ % n_stripes;
+  return stripe;
+}
+
+size_t log2_floor(size_t x)
+{
+  size_t n = 0;
+  while (x >>= 1) {
+    n++;
+  }
+  return n;
+}
+}  // namespace
+
+serdata_rmw * allocate_serdata(
+  const struct ddsi_sertype * type, enum ddsi_serdata_kind kind, size_t capacity)
+{
+  size_t k = 0;
+  while (k < n_classes && (size_t{1} << (min_class_log2 + k)) < capacity) {
+    k++;
+  }
+  if (k == n_classes) {
+    auto d = std::make_unique<serdata_rmw>(type, kind);
+    d->reserve(capacity);
+    return d.release();
+  }
+
+  SerdataPool & pool = get_pool();
+  SizeClass & size_class = pool.classes[k];
+  const size_t home = home_stripe(pool);
+  for (size_t i = 0; i < n_stripes; i++) {
+    Stripe & stripe = size_class.stripes[(home + i) % n_stripes];
+    std::unique_lock<std::mutex> lock(stripe.lock, std::defer_lock);
+    /* don't wait for other threads' stripes, there's a good chance it'll pay to allocate */
+    if (i == 0) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      continue;
+    }
+    if (!stripe.free.empty()) {
+      serdata_rmw * d = stripe.free.back();
+      stripe.free.pop_back();
+      lock.unlock();
+      ddsi_serdata_init(d, type, kind);
+      d->resize(0);
+      d->reset_serialize_state();
+      return d;
+    }
+  }
+
+  auto d = std::make_unique<serdata_rmw>(type, kind);
+  d->reserve(size_t{1} << (min_class_log2 + k));
+  return d.release();
+}
+
+void release_serdata(serdata_rmw * d)
+{
+  const size_t capacity = d->capacity();
+  if (capacity < (size_t{1} << min_class_log2)) {
+    delete d;
+    return;
+  }
+  const size_t k = log2_floor(capacity) - min_class_log2;
+  if (k >= n_classes) {
+    delete d;
+    return;
+  }
+
+  SerdataPool & pool = get_pool();
+  SizeClass & size_class = pool.classes[k];
+  Stripe & stripe = size_class.stripes[home_stripe(pool)];
+  {
+    std::lock_guard<std::mutex> lock(stripe.lock);
+    if (stripe.free.size() < size_class.max_per_stripe) {
+      stripe.free.push_back(d);
+      return;
+    }
+  }
+  delete d;
+}
+
+}  // namespace rmw_cyclonedds_cpp
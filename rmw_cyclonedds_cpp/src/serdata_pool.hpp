@@ -0,0 +1,36 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef SERDATA_POOL_HPP_
+#define SERDATA_POOL_HPP_
+
+#include <cstddef>
+
+#include "serdata.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+/// Return a serdata_rmw initialized for this type and kind, with an empty payload whose buffer
+/// can hold at least `capacity` bytes.  Freed serdata are recycled together with their buffers,
+/// so in a steady state neither the serdata nor its payload need to be allocated.
+serdata_rmw * allocate_serdata(
+  const struct ddsi_sertype * type, enum ddsi_serdata_kind kind, size_t capacity);
+
+/// Give a serdata_rmw that is no longer referenced back to the pool, or delete it if the pool
+/// already holds enough of its size.
+void release_serdata(serdata_rmw * d);
+
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // SERDATA_POOL_HPP_
@@ -25,6 +25,7 @@
 #include <vector>
 #include <type_traits>
 
+#include "byteswap.hpp"
 #include "deserialization_exception.hpp"
 
 using rmw_cyclonedds_cpp::DeserializationException;
@@ -72,6 +73,17 @@ protected:
       }
     }
   }
+  // copies cnt elements of el_sz bytes at the current position into x, converting them to
+  // native byte order; the caller has aligned and validated the position
+  inline void copy_elements(void * x, size_t cnt, size_t el_sz)
+  {
+    if (swap_bytes) {
+      rmw_cyclonedds_cpp::byteswap_copy(x, data + pos, cnt, el_sz);
+    } else {
+      memcpy(x, data + pos, cnt * el_sz);
+    }
+    pos += cnt * el_sz;
+  }
   inline void validate_size(size_t count, size_t sz)
   {
     assert(sz == 1 || sz == 2 || sz == 4 || sz == 8);
@@ -112,6 +124,7 @@ public:
   inline cycdeser & operator>>(double & x) {deserialize(x); return *this;}
   inline cycdeser & operator>>(std::string & x) {deserialize(x); return *this;}
   inline cycdeser & operator>>(std::wstring & x) {deserialize(x); return *this;}
+  inline cycdeser & operator>>(std::u16string & x) {deserialize(x); return *this;}
   template<class T>
   inline cycdeser & operator>>(std::vector<T> & x) {deserialize(x); return *this;}
   template<class T, size_t S>
@@ -148,6 +161,19 @@ public:
   {
     deserialize(*reinterpret_cast<uint64_t *>(&x));
   }
+  inline bool swaps_bytes() const {return swap_bytes;}
+  // position modulo 8 after aligning to a, to check whether data can be copied verbatim
+  inline size_t aligned_phase(size_t a)
+  {
+    align(a);
+    return pos % 8;
+  }
+  inline void deserialize_bytes(void * x, size_t n)
+  {
+    validate_size(n, 1);
+    memcpy(x, data + pos, n);
+    pos += n;
+  }
   inline uint32_t deserialize_len(size_t el_sz)
   {
     uint32_t sz;
@@ -155,52 +181,71 @@ public:
     validate_size(sz, el_sz);
     return sz;
   }
-  inline void deserialize(std::string & x)
+  // returns the characters of a string in the input, without the terminating null, so the
+  // caller can copy them into its own buffer
+  inline const char * deserialize_string_data(size_t & len)
   {
     const uint32_t sz = deserialize_len(sizeof(char));
-    if (sz == 0) {
-      x = std::string("");
-    } else {
-      validate_str(sz);
-      x = std::string(data + pos, sz - 1);
-    }
+    const char * str = data + pos;
+    validate_str(sz);
+    len = (sz == 0) ? 0 : sz - 1;
     pos += sz;
+    return str;
+  }
+  inline void deserialize(std::string & x)
+  {
+    // assign reuses the existing buffer of x if it is large enough
+    size_t len;
+    const char * str = deserialize_string_data(len);
+    x.assign(str, len);
   }
   inline void deserialize(std::wstring & x)
   {
     const uint32_t sz = deserialize_len(sizeof(wchar_t));
     // wstring is not null-terminated in cdr
-    x = std::wstring(reinterpret_cast<const wchar_t *>(data + pos), sz);
-    pos += sz * sizeof(wchar_t);
+    x.resize(sz);
+    copy_elements(&x[0], sz, sizeof(wchar_t));
+  }
+  // converts the next cnt wide characters in the input to UTF-16 code units in x, truncating
+  // each like a cast to a 16-bit type; the wide characters are converted a block at a time so that
+  // byte swapping can use the vectorized kernels
+  template<class C>
+  inline void deserialize_wchars(C * x, size_t cnt)
+  {
+    wchar_t block[64];
+    for (size_t i = 0; i < cnt; i += 64) {
+      const size_t n = (cnt - i < 64) ? cnt - i : 64;
+      copy_elements(block, n, sizeof(wchar_t));
+      for (size_t j = 0; j < n; j++) {
+        x[i + j] = static_cast<C>(block[j]);
+      }
+    }
+  }
+  inline void deserialize(std::u16string & x)
+  {
+    // wstring is not null-terminated in cdr; resize reuses the existing buffer of x if it is
+    // large enough
+    const uint32_t sz = deserialize_len(sizeof(wchar_t));
+    x.resize(sz);
+    deserialize_wchars(&x[0], sz);
   }
 
-#define DESER8_A(T) DESER_A(T, )
-#define DESER_A(T, fn_swap) inline void deserializeA(T * x, size_t cnt) { \
+#define DESER_A(T) inline void deserializeA(T * x, size_t cnt) { \
     if (cnt > 0) { \
       align(sizeof(T)); \
       validate_size(cnt, sizeof(T)); \
-      if (swap_bytes) { \
-        for (size_t i = 0; i < cnt; i++) { \
-          x[i] = fn_swap(*reinterpret_cast<const T *>(data + pos)); \
-          pos += sizeof(T); \
-        } \
-      } else { \
-        memcpy( \
-          reinterpret_cast<void *>(x), reinterpret_cast<const void *>(data + pos), \
-          cnt * sizeof(T)); \
-        pos += cnt * sizeof(T); \
-      } \
+      copy_elements(x, cnt, sizeof(T)); \
     } \
 }
-  DESER8_A(char);
-  DESER8_A(int8_t);
-  DESER8_A(uint8_t);
-  DESER_A(int16_t, bswap2);
-  DESER_A(uint16_t, bswap2u);
-  DESER_A(int32_t, bswap4);
-  DESER_A(uint32_t, bswap4u);
-  DESER_A(int64_t, bswap8);
-  DESER_A(uint64_t, bswap8u);
+  DESER_A(char);
+  DESER_A(int8_t);
+  DESER_A(uint8_t);
+  DESER_A(int16_t);
+  DESER_A(uint16_t);
+  DESER_A(int32_t);
+  DESER_A(uint32_t);
+  DESER_A(int64_t);
+  DESER_A(uint64_t);
 #undef DESER_A
 
   inline void deserializeA(float * x, size_t cnt)
@@ -342,9 +387,9 @@ public:
   {
     const uint32_t sz = get_len(sizeof(wchar_t));
     // wstring is not null-terminated in cdr
-    x = std::wstring(reinterpret_cast<const wchar_t *>(data + pos), sz);
+    x.resize(sz);
+    copy_elements(&x[0], sz, sizeof(wchar_t));
     prtf(&buf, &bufsize, "\"%ls\"", x.c_str());
-    pos += sz * sizeof(wchar_t);
   }
 
   template<class T>
@@ -358,6 +403,35 @@ public:
     prtf(&buf, &bufsize, "}");
   }
 
+  // arrays of multi-byte primitives are converted to native byte order a block at a time
+#define PRNT_A(T, F) inline void printA(T * x, size_t cnt) { \
+    static_cast<void>(x); \
+    prtf(&buf, &bufsize, "{"); \
+    if (cnt > 0) { \
+      align(sizeof(T)); \
+      validate_size(cnt, sizeof(T)); \
+      T block[64]; \
+      for (size_t i = 0; i < cnt; i += 64) { \
+        const size_t n = (cnt - i < 64) ? cnt - i : 64; \
+        copy_elements(block, n, sizeof(T)); \
+        for (size_t j = 0; j < n; j++) { \
+          if (i + j != 0) {prtf(&buf, &bufsize, ",");} \
+          prtf(&buf, &bufsize, F, block[j]); \
+        } \
+      } \
+    } \
+    prtf(&buf, &bufsize, "}"); \
+}
+  PRNT_A(int16_t, "%" PRId16);
+  PRNT_A(uint16_t, "%" PRIu16);
+  PRNT_A(int32_t, "%" PRId32);
+  PRNT_A(uint32_t, "%" PRIu32);
+  PRNT_A(int64_t, "%" PRId64);
+  PRNT_A(uint64_t, "%" PRIu64);
+  PRNT_A(float, "%f");
+  PRNT_A(double, "%f");
+#undef PRNT_A
+
   template<class T>
   inline void print(std::vector<T> & x)
   {
@@ -0,0 +1,90 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "serialization_cache.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+/* Enough for recording every topic of a large system without thrashing, while still putting
+   a limit on the memory used by a process that goes through many types. */
+constexpr size_t max_cached_types = 256;
+
+using CacheKey = const rosidl_message_type_support_t *;
+using CacheValue = std::shared_ptr<const RegisteredType>;
+
+/* Leaked rather than destroyed for the same reason as the codec registry: rmw_serialize may
+   still be called from other threads while the process is exiting. */
+struct SerializationCache
+{
+  std::mutex lock;
+  /* most recently used first */
+  std::list<std::pair<CacheKey, CacheValue>> entries;
+  std::unordered_map<CacheKey, std::list<std::pair<CacheKey, CacheValue>>::iterator> index;
+};
+
+SerializationCache & get_cache()
+{
+  static SerializationCache * cache = new SerializationCache;
+  return *cache;
+}
+
+/* Must be called with the lock held */
+CacheValue lookup(SerializationCache & cache, CacheKey key)
+{
+  auto it = cache.index.find(key);
+  if (it == cache.index.end()) {
+    return nullptr;
+  }
+  cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+  return it->second->second;
+}
+
+}  // namespace
+
+std::shared_ptr<const RegisteredType> get_serialization_cache_entry(
+  const rosidl_message_type_support_t * type_support)
+{
+  SerializationCache & cache = get_cache();
+  {
+    std::lock_guard<std::mutex> lock(cache.lock);
+    if (auto entry = lookup(cache, type_support)) {
+      return entry;
+    }
+  }
+
+  /* The registry may have to build the entry, which can take a while for large types, so do
+     it without holding the lock, and if another thread was faster, use the entry it added. */
+  CacheValue entry = get_registered_message_type(type_support);
+  std::lock_guard<std::mutex> lock(cache.lock);
+  if (auto existing = lookup(cache, type_support)) {
+    return existing;
+  }
+  cache.entries.emplace_front(type_support, entry);
+  cache.index.emplace(type_support, cache.entries.begin());
+  if (cache.entries.size() > max_cached_types) {
+    cache.index.erase(cache.entries.back().first);
+    cache.entries.pop_back();
+  }
+  return entry;
+}
+
+}  // namespace rmw_cyclonedds_cpp
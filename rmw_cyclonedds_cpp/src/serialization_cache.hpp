@@ -0,0 +1,35 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef SERIALIZATION_CACHE_HPP_
+#define SERIALIZATION_CACHE_HPP_
+
+#include <memory>
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "type_registry.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+/// Return the registered type for the type support handle passed to rmw_serialize and
+/// rmw_deserialize, resolving the handle only on first use.  The cache holds a bounded number
+/// of types, evicting the least recently used one, and keeps those alive in the type registry;
+/// an evicted entry stays valid for as long as the caller holds on to it.  Throws if the type
+/// support is not usable by this implementation.
+std::shared_ptr<const RegisteredType> get_serialization_cache_entry(
+  const rosidl_message_type_support_t * type_support);
+
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // SERIALIZATION_CACHE_HPP_
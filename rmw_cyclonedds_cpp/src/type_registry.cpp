@@ -0,0 +1,294 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "type_registry.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "MessageTypeSupport.hpp"
+#include "ServiceTypeSupport.hpp"
+#include "TypeSupport2.hpp"
+#include "generated_codecs.hpp"
+#include "rcutils/error_handling.h"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+namespace
+{
+using TypeSupport_c = TypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
+using TypeSupport_cpp = TypeSupport<rosidl_typesupport_introspection_cpp::MessageMembers>;
+using MessageTypeSupport_c = MessageTypeSupport<rosidl_typesupport_introspection_c__MessageMembers>;
+using MessageTypeSupport_cpp =
+  MessageTypeSupport<rosidl_typesupport_introspection_cpp::MessageMembers>;
+using RequestTypeSupport_c = RequestTypeSupport<
+  rosidl_typesupport_introspection_c__ServiceMembers,
+  rosidl_typesupport_introspection_c__MessageMembers>;
+using RequestTypeSupport_cpp = RequestTypeSupport<
+  rosidl_typesupport_introspection_cpp::ServiceMembers,
+  rosidl_typesupport_introspection_cpp::MessageMembers>;
+using ResponseTypeSupport_c = ResponseTypeSupport<
+  rosidl_typesupport_introspection_c__ServiceMembers,
+  rosidl_typesupport_introspection_c__MessageMembers>;
+using ResponseTypeSupport_cpp = ResponseTypeSupport<
+  rosidl_typesupport_introspection_cpp::ServiceMembers,
+  rosidl_typesupport_introspection_cpp::MessageMembers>;
+
+bool using_introspection_c_typesupport(const char * typesupport_identifier)
+{
+  return typesupport_identifier == rosidl_typesupport_introspection_c__identifier;
+}
+
+/* Types are registered under the introspection type support handle, which is what the
+   introspection data hangs off, and the role, because a service type support gives two types */
+using RegistryKey = std::pair<const void *, TypeRole>;
+
+/* Leaked rather than destroyed for the same reason as the codec registry: sertypes may still be
+   freed by Cyclone while the process is exiting. */
+struct TypeRegistry
+{
+  std::mutex lock;
+  std::map<RegistryKey, std::weak_ptr<const RegisteredType>> types;
+};
+
+TypeRegistry & get_registry()
+{
+  static TypeRegistry * registry = new TypeRegistry;
+  return *registry;
+}
+
+template<typename MakeEntry>
+std::shared_ptr<const RegisteredType> get_or_make_entry(RegistryKey key, MakeEntry make_entry)
+{
+  TypeRegistry & registry = get_registry();
+  {
+    std::lock_guard<std::mutex> lock(registry.lock);
+    auto it = registry.types.find(key);
+    if (it != registry.types.end()) {
+      if (auto entry = it->second.lock()) {
+        return entry;
+      }
+    }
+  }
+
+  /* Building the entry can take a while for large types, so do it without holding the lock,
+     and if another thread was faster, use the entry it added. */
+  std::shared_ptr<const RegisteredType> entry = make_entry();
+  std::lock_guard<std::mutex> lock(registry.lock);
+  auto & slot = registry.types[key];
+  if (auto existing = slot.lock()) {
+    return existing;
+  }
+  slot = entry;
+  /* forget about the types no one uses anymore while we're at it, this is rare enough */
+  for (auto it = registry.types.begin(); it != registry.types.end(); ) {
+    if (it->second.expired()) {
+      it = registry.types.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return entry;
+}
+
+/* Alignment of a value in memory, for the types a memcpy-serialized type can contain */
+size_t memory_alignment(const AnyValueType * value_type)
+{
+  switch (value_type->e_value_type()) {
+    case EValueType::PrimitiveValueType:
+      return value_type->sizeof_type();
+    case EValueType::ArrayValueType:
+      return memory_alignment(
+        static_cast<const ArrayValueType *>(value_type)->element_value_type());
+    case EValueType::StructValueType: {
+        auto struct_value_type = static_cast<const StructValueType *>(value_type);
+        size_t align = 1;
+        for (size_t i = 0; i < struct_value_type->n_members(); i++) {
+          align = std::max(align, memory_alignment(struct_value_type->get_member(i)->value_type));
+        }
+        return align;
+      }
+    default:
+      throw std::logic_error("not a type that can be memcpy-serialized");
+  }
+}
+
+/* Fill in everything that follows from the introspection typesupport and the value type */
+void complete_entry(RegisteredType & entry, std::unique_ptr<StructValueType> value_type)
+{
+  entry.writer = make_cdr_writer(std::move(value_type));
+  entry.fixed_serialized_size = entry.writer->get_fixed_serialized_size();
+  entry.is_memcpy_serialized = entry.writer->is_memcpy_serialized();
+  if (entry.is_memcpy_serialized) {
+    entry.memcpy_alignment = memory_alignment(&entry.writer->root_value_type());
+  }
+  if (using_introspection_c_typesupport(entry.typesupport_identifier)) {
+    entry.type_name = static_cast<TypeSupport_c *>(entry.type_support)->getName();
+  } else {
+    auto ts = static_cast<TypeSupport_cpp *>(entry.type_support);
+    entry.type_name = ts->getName();
+    /* a memcpy is as good as it gets, and only plain messages have a generated codec */
+    if (entry.role == TypeRole::Message && !entry.is_memcpy_serialized) {
+      entry.codec = find_generated_codec(ts->getMembers());
+    }
+  }
+  entry.serialize_by_reference = entry.role == TypeRole::Message && entry.codec == nullptr &&
+    entry.writer->may_reference_data();
+}
+
+std::shared_ptr<const RegisteredType> make_message_entry(const rosidl_message_type_support_t * ts)
+{
+  auto entry = std::make_shared<RegisteredType>();
+  entry->role = TypeRole::Message;
+  entry->typesupport_identifier = ts->typesupport_identifier;
+  if (using_introspection_c_typesupport(ts->typesupport_identifier)) {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(ts->data);
+    auto mts = new MessageTypeSupport_c(members);
+    entry->type_support = mts;
+    mts->buildDeserializationPlan();
+    entry->is_fixed_type = mts->is_type_self_contained();
+    entry->sample_size = static_cast<uint32_t>(members->size_of_);
+  } else {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(ts->data);
+    auto mts = new MessageTypeSupport_cpp(members);
+    entry->type_support = mts;
+    mts->buildDeserializationPlan();
+    entry->is_fixed_type = mts->is_type_self_contained();
+    entry->sample_size = static_cast<uint32_t>(members->size_of_);
+  }
+  complete_entry(*entry, make_message_value_type(ts));
+  return entry;
+}
+
+std::shared_ptr<const RegisteredType> make_service_entry(
+  const rosidl_service_type_support_t * ts, TypeRole role)
+{
+  auto entry = std::make_shared<RegisteredType>();
+  entry->role = role;
+  entry->typesupport_identifier = ts->typesupport_identifier;
+  if (using_introspection_c_typesupport(ts->typesupport_identifier)) {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_c__ServiceMembers *>(ts->data);
+    TypeSupport_c * sts;
+    if (role == TypeRole::Request) {
+      entry->type_support = sts = new RequestTypeSupport_c(members);
+    } else {
+      entry->type_support = sts = new ResponseTypeSupport_c(members);
+    }
+    sts->buildDeserializationPlan();
+  } else {
+    auto members =
+      static_cast<const rosidl_typesupport_introspection_cpp::ServiceMembers *>(ts->data);
+    TypeSupport_cpp * sts;
+    if (role == TypeRole::Request) {
+      entry->type_support = sts = new RequestTypeSupport_cpp(members);
+    } else {
+      entry->type_support = sts = new ResponseTypeSupport_cpp(members);
+    }
+    sts->buildDeserializationPlan();
+  }
+  auto value_types = make_request_response_value_types(ts);
+  complete_entry(
+    *entry,
+    std::move((role == TypeRole::Request) ? value_types.first : value_types.second));
+  return entry;
+}
+}  // namespace
+
+RegisteredType::~RegisteredType()
+{
+  if (type_support != nullptr) {
+    if (using_introspection_c_typesupport(typesupport_identifier)) {
+      delete static_cast<TypeSupport_c *>(type_support);
+    } else {
+      delete static_cast<TypeSupport_cpp *>(type_support);
+    }
+  }
+}
+
+bool RegisteredType::deserialize(cycdeser & deser, void * ros_message) const
+{
+  if (using_introspection_c_typesupport(typesupport_identifier)) {
+    return static_cast<TypeSupport_c *>(type_support)->deserializeROSmessage(
+      deser, ros_message, nullptr);
+  } else {
+    return static_cast<TypeSupport_cpp *>(type_support)->deserializeROSmessage(
+      deser, ros_message, nullptr);
+  }
+}
+
+bool RegisteredType::get_max_serialized_size(
+  const rmw_cyclonedds_cpp_sequence_bounds_t * bounds, size_t & size) const
+{
+  if (using_introspection_c_typesupport(typesupport_identifier)) {
+    return static_cast<TypeSupport_c *>(type_support)->get_max_serialized_size(bounds, size);
+  } else {
+    return static_cast<TypeSupport_cpp *>(type_support)->get_max_serialized_size(bounds, size);
+  }
+}
+
+std::shared_ptr<const RegisteredType> get_registered_message_type(
+  const rosidl_message_type_support_t * type_support)
+{
+  const rosidl_message_type_support_t * ts;
+  if ((ts =
+    get_message_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_c__identifier)) == nullptr)
+  {
+    rcutils_reset_error();
+    if ((ts =
+      get_message_typesupport_handle(
+        type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier)) == nullptr)
+    {
+      rcutils_reset_error();
+      throw std::runtime_error("type support not from this implementation");
+    }
+  }
+  return get_or_make_entry(
+    RegistryKey(ts, TypeRole::Message), [ts]() {return make_message_entry(ts);});
+}
+
+std::shared_ptr<const RegisteredType> get_registered_service_type(
+  const rosidl_service_type_support_t * type_support, TypeRole role)
+{
+  if (role == TypeRole::Message) {
+    throw std::invalid_argument("a service type support has no message type");
+  }
+  const rosidl_service_type_support_t * ts;
+  if ((ts =
+    get_service_typesupport_handle(
+      type_support, rosidl_typesupport_introspection_c__identifier)) == nullptr)
+  {
+    rcutils_reset_error();
+    if ((ts =
+      get_service_typesupport_handle(
+        type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier)) == nullptr)
+    {
+      rcutils_reset_error();
+      throw std::runtime_error("service type support not from this implementation");
+    }
+  }
+  return get_or_make_entry(
+    RegistryKey(ts, role), [ts, role]() {return make_service_entry(ts, role);});
+}
+
+}  // namespace rmw_cyclonedds_cpp
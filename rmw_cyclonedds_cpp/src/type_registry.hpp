@@ -0,0 +1,94 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TYPE_REGISTRY_HPP_
+#define TYPE_REGISTRY_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Serialization.hpp"
+#include "rmw_cyclonedds_cpp/sequence_bounds.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "rosidl_runtime_c/service_type_support_struct.h"
+#include "serdes.hpp"
+
+namespace rmw_cyclonedds_cpp
+{
+
+struct GeneratedCodec;
+
+/// What a type is used for: the same service type support gives two types, the request and the
+/// response, both of which are serialized with a request header in front.
+enum class TypeRole
+{
+  Message,
+  Request,
+  Response
+};
+
+/// Everything derived from the introspection data of a type: the value type and CDR writer for
+/// serializing it, the introspection typesupport with the deserialization plan, and the
+/// properties the sertype needs.  Entries are immutable once created, so they can be shared by
+/// all publishers, subscriptions, clients and services using the type, and used by any number
+/// of threads at the same time.
+struct RegisteredType
+{
+  RegisteredType() = default;
+  RegisteredType(const RegisteredType &) = delete;
+  RegisteredType & operator=(const RegisteredType &) = delete;
+  ~RegisteredType();
+
+  TypeRole role {TypeRole::Message};
+  const char * typesupport_identifier {nullptr};
+  /* a MessageTypeSupport, RequestTypeSupport or ResponseTypeSupport matching
+     typesupport_identifier, owned by the entry */
+  void * type_support {nullptr};
+  std::unique_ptr<const BaseCDRWriter> writer;
+  std::string type_name;
+  /* the sample contains no pointers (messages only) */
+  bool is_fixed_type {false};
+  /* size of the sample in memory (messages only, 0 otherwise) */
+  uint32_t sample_size {0};
+  /* serialized size of every sample if it doesn't depend on the contents, 0 otherwise */
+  size_t fixed_serialized_size {0};
+  /* samples are serialized as the CDR header followed by a verbatim copy of the sample */
+  bool is_memcpy_serialized {false};
+  /* for a memcpy-serialized type, the alignment serialized data must have to be used as a
+     sample in place, 0 otherwise */
+  size_t memcpy_alignment {0};
+  /* type-specialised serializer generated at build time, if any */
+  const GeneratedCodec * codec {nullptr};
+  /* large arrays in the sample may be referenced rather than copied when publishing */
+  bool serialize_by_reference {false};
+
+  /* deserialize a message, for messages only as requests and responses have a header */
+  bool deserialize(cycdeser & deser, void * ros_message) const;
+  bool get_max_serialized_size(
+    const rmw_cyclonedds_cpp_sequence_bounds_t * bounds, size_t & size) const;
+};
+
+/// Return the shared entry for a message type, creating it if no one is using the type yet.
+/// The entry is removed from the registry once the last reference to it is dropped.  Throws if
+/// the type support is not usable by this implementation.
+std::shared_ptr<const RegisteredType> get_registered_message_type(
+  const rosidl_message_type_support_t * type_support);
+
+/// Same for the request or response type of a service.
+std::shared_ptr<const RegisteredType> get_registered_service_type(
+  const rosidl_service_type_support_t * type_support, TypeRole role);
+
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // TYPE_REGISTRY_HPP_
@@ -0,0 +1,111 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "worker_pool.hpp"
+
+#include <algorithm>
+
+namespace rmw_cyclonedds_cpp
+{
+
+/* Beyond this, deserializing a batch is limited by memory bandwidth rather than by cores */
+static constexpr unsigned max_pool_threads = 8;
+
+WorkerPool::WorkerPool(size_t n_threads)
+{
+  m_threads.reserve(n_threads);
+  for (size_t i = 0; i < n_threads; i++) {
+    m_threads.emplace_back(&WorkerPool::worker, this);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_stop = true;
+  }
+  m_job_cond.notify_all();
+  for (auto & t : m_threads) {
+    t.join();
+  }
+}
+
+WorkerPool & WorkerPool::get()
+{
+  /* Leaked rather than destroyed, so that a take on another thread during process exit
+     doesn't find it gone.  The calling thread does part of the work, hence one fewer. */
+  static WorkerPool * pool = new WorkerPool(
+    std::min(std::max(std::thread::hardware_concurrency(), 1u), max_pool_threads) - 1);
+  return *pool;
+}
+
+void WorkerPool::work_on(Job & job)
+{
+  size_t i;
+  while ((i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.count) {
+    job.task(job.arg, i);
+  }
+}
+
+void WorkerPool::worker()
+{
+  std::unique_lock<std::mutex> lock(m_lock);
+  uint64_t seen = m_generation;
+  while (true) {
+    m_job_cond.wait(lock, [this, seen]() {return m_stop || (m_job && m_generation != seen);});
+    if (m_stop) {
+      return;
+    }
+    seen = m_generation;
+    Job * job = m_job;
+    job->active++;
+    lock.unlock();
+    work_on(*job);
+    lock.lock();
+    if (--job->active == 0) {
+      m_done_cond.notify_all();
+    }
+  }
+}
+
+void WorkerPool::run(Task task, void * arg, size_t count)
+{
+  std::unique_lock<std::mutex> run_lock(m_run_lock, std::try_to_lock);
+  if (!run_lock.owns_lock() || m_threads.empty() || count < 2) {
+    for (size_t i = 0; i < count; i++) {
+      task(arg, i);
+    }
+    return;
+  }
+
+  Job job;
+  job.task = task;
+  job.arg = arg;
+  job.count = count;
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_job = &job;
+    m_generation++;
+  }
+  m_job_cond.notify_all();
+  work_on(job);
+
+  /* all calls have been started, wait for the workers that are still busy; workers that only
+     now wake up can't get at the job anymore once it is no longer the current one */
+  std::unique_lock<std::mutex> lock(m_lock);
+  m_done_cond.wait(lock, [&job]() {return job.active == 0;});
+  m_job = nullptr;
+}
+
+}  // namespace rmw_cyclonedds_cpp
@@ -0,0 +1,74 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef WORKER_POOL_HPP_
+#define WORKER_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rmw_cyclonedds_cpp
+{
+
+/// A small set of threads for spreading independent pieces of work, such as deserializing the
+/// messages of a batch, over several cores.
+class WorkerPool
+{
+public:
+  using Task = void (*)(void * arg, size_t index);
+
+  explicit WorkerPool(size_t n_threads);
+  ~WorkerPool();
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool & operator=(const WorkerPool &) = delete;
+
+  /// Call task(arg, i) for every i in [0, count), on the worker threads as well as on the
+  /// calling thread, and return once all calls have returned.  If the pool is already busy
+  /// with work for another thread, everything is done on the calling thread instead of waiting.
+  void run(Task task, void * arg, size_t count);
+
+  /// The pool for the RMW layer, created on first use
+  static WorkerPool & get();
+
+private:
+  struct Job
+  {
+    Task task;
+    void * arg;
+    size_t count;
+    std::atomic<size_t> next {0};
+    /* number of worker threads working on the job, protected by m_lock */
+    size_t active {0};
+  };
+
+  static void work_on(Job & job);
+  void worker();
+
+  std::mutex m_run_lock;
+  std::mutex m_lock;
+  std::condition_variable m_job_cond;
+  std::condition_variable m_done_cond;
+  Job * m_job {nullptr};
+  uint64_t m_generation {0};
+  bool m_stop {false};
+  std::vector<std::thread> m_threads;
+};
+
+}  // namespace rmw_cyclonedds_cpp
+
+#endif  // WORKER_POOL_HPP_
@@ -0,0 +1,30 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef TEST_TYPES__MSG__FLAT_HPP_
+#define TEST_TYPES__MSG__FLAT_HPP_
+
+/* Stands in for the header rosidl would generate from test/msg/Flat.idl, which the codec
+   that generate_codecs.py generates from it includes */
+
+#include "message_types.hpp"
+
+namespace test_types
+{
+namespace msg
+{
+using Flat = ::test_types::Flat;
+}  // namespace msg
+}  // namespace test_types
+
+#endif  // TEST_TYPES__MSG__FLAT_HPP_
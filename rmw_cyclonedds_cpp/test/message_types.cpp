@@ -0,0 +1,376 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "message_types.hpp"
+
+#include <cstring>
+#include <new>
+
+namespace test_types
+{
+
+namespace
+{
+
+template<typename T>
+size_t vector_size(const void * v)
+{
+  return static_cast<const std::vector<T> *>(v)->size();
+}
+
+template<typename T>
+const void * vector_get_const(const void * v, size_t i)
+{
+  return &(*static_cast<const std::vector<T> *>(v))[i];
+}
+
+template<typename T>
+void * vector_get(void * v, size_t i)
+{
+  return &(*static_cast<std::vector<T> *>(v))[i];
+}
+
+template<typename T>
+void vector_resize(void * v, size_t n)
+{
+  static_cast<std::vector<T> *>(v)->resize(n);
+}
+
+template<typename T, size_t N>
+size_t array_size(const void *)
+{
+  return N;
+}
+
+template<typename T, size_t N>
+const void * array_get_const(const void * a, size_t i)
+{
+  return &(*static_cast<const std::array<T, N> *>(a))[i];
+}
+
+template<typename T, size_t N>
+void * array_get(void * a, size_t i)
+{
+  return &(*static_cast<std::array<T, N> *>(a))[i];
+}
+
+tsi::MessageMember member(
+  const char * name, uint8_t type_id, size_t offset,
+  const rosidl_message_type_support_t * members = nullptr)
+{
+  tsi::MessageMember m{};
+  m.name_ = name;
+  m.type_id_ = type_id;
+  m.offset_ = static_cast<uint32_t>(offset);
+  m.members_ = members;
+  return m;
+}
+
+template<typename T>
+tsi::MessageMember sequence(tsi::MessageMember m)
+{
+  m.is_array_ = true;
+  m.size_function = vector_size<T>;
+  m.get_const_function = vector_get_const<T>;
+  m.get_function = vector_get<T>;
+  m.resize_function = vector_resize<T>;
+  return m;
+}
+
+/* std::vector<bool> has no addressable elements, the serializers special-case it */
+tsi::MessageMember bool_sequence(tsi::MessageMember m)
+{
+  m.is_array_ = true;
+  return m;
+}
+
+template<typename T, size_t N>
+tsi::MessageMember array(tsi::MessageMember m)
+{
+  m.is_array_ = true;
+  m.array_size_ = N;
+  m.size_function = array_size<T, N>;
+  m.get_const_function = array_get_const<T, N>;
+  m.get_function = array_get<T, N>;
+  return m;
+}
+
+template<typename T>
+void init_message(void * msg, rosidl_runtime_cpp::MessageInitialization)
+{
+  new (msg) T();
+}
+
+template<typename T>
+void fini_message(void * msg)
+{
+  static_cast<T *>(msg)->~T();
+}
+
+template<typename T, size_t N>
+tsi::MessageMembers message_members(const char * name, const tsi::MessageMember (&members)[N])
+{
+  tsi::MessageMembers m{};
+  m.message_namespace_ = "test_types::msg";
+  m.message_name_ = name;
+  m.member_count_ = N;
+  m.size_of_ = sizeof(T);
+  m.members_ = members;
+  m.init_function = init_message<T>;
+  m.fini_function = fini_message<T>;
+  return m;
+}
+
+rosidl_message_type_support_t type_support(const tsi::MessageMembers & members)
+{
+  rosidl_message_type_support_t ts{};
+  ts.typesupport_identifier = tsi::typesupport_identifier;
+  ts.data = &members;
+  ts.func = get_message_typesupport_handle_function;
+  return ts;
+}
+
+const tsi::MessageMember Nested_m[] = {
+  member("a", tsi::ROS_TYPE_UINT8, offsetof(Nested, a)),
+  member("b", tsi::ROS_TYPE_DOUBLE, offsetof(Nested, b)),
+};
+const tsi::MessageMembers Nested_members = message_members<Nested>("Nested", Nested_m);
+
+const tsi::MessageMember Vec3f_m[] = {
+  member("x", tsi::ROS_TYPE_FLOAT, offsetof(Vec3f, x)),
+  member("y", tsi::ROS_TYPE_FLOAT, offsetof(Vec3f, y)),
+  member("z", tsi::ROS_TYPE_FLOAT, offsetof(Vec3f, z)),
+};
+const tsi::MessageMembers Vec3f_members = message_members<Vec3f>("Vec3f", Vec3f_m);
+
+const tsi::MessageMember Flat_m[] = {
+  member("a", tsi::ROS_TYPE_DOUBLE, offsetof(Flat, a)),
+  member("b", tsi::ROS_TYPE_INT32, offsetof(Flat, b)),
+  member("c", tsi::ROS_TYPE_INT32, offsetof(Flat, c)),
+  array<Vec3f, 2>(member("v", tsi::ROS_TYPE_MESSAGE, offsetof(Flat, v), &Vec3f_ts)),
+  member("z", tsi::ROS_TYPE_UINT64, offsetof(Flat, z)),
+};
+const tsi::MessageMembers Flat_members = message_members<Flat>("Flat", Flat_m);
+
+const tsi::MessageMember FlatPadded_m[] = {
+  member("a", tsi::ROS_TYPE_UINT8, offsetof(FlatPadded, a)),
+  member("b", tsi::ROS_TYPE_DOUBLE, offsetof(FlatPadded, b)),
+  member("c", tsi::ROS_TYPE_INT16, offsetof(FlatPadded, c)),
+};
+const tsi::MessageMembers FlatPadded_members =
+  message_members<FlatPadded>("FlatPadded", FlatPadded_m);
+
+const tsi::MessageMember Everything_m[] = {
+  member("u8", tsi::ROS_TYPE_UINT8, offsetof(Everything, u8)),
+  member("nested", tsi::ROS_TYPE_MESSAGE, offsetof(Everything, nested), &Nested_ts),
+  array<Vec3f, 3>(member("points", tsi::ROS_TYPE_MESSAGE, offsetof(Everything, points), &Vec3f_ts)),
+  sequence<double>(member("doubles", tsi::ROS_TYPE_DOUBLE, offsetof(Everything, doubles))),
+  member("str", tsi::ROS_TYPE_STRING, offsetof(Everything, str)),
+  sequence<Vec3f>(
+    member("vectors", tsi::ROS_TYPE_MESSAGE, offsetof(Everything, vectors), &Vec3f_ts)),
+  sequence<Nested>(
+    member("nesteds", tsi::ROS_TYPE_MESSAGE, offsetof(Everything, nesteds), &Nested_ts)),
+  sequence<std::string>(member("strings", tsi::ROS_TYPE_STRING, offsetof(Everything, strings))),
+  member("i16", tsi::ROS_TYPE_INT16, offsetof(Everything, i16)),
+  bool_sequence(member("bools", tsi::ROS_TYPE_BOOLEAN, offsetof(Everything, bools))),
+  array<Nested, 2>(
+    member("nested_array", tsi::ROS_TYPE_MESSAGE, offsetof(Everything, nested_array), &Nested_ts)),
+  sequence<uint8_t>(member("bytes", tsi::ROS_TYPE_UINT8, offsetof(Everything, bytes))),
+  member("i64", tsi::ROS_TYPE_INT64, offsetof(Everything, i64)),
+  member("wstr", tsi::ROS_TYPE_WSTRING, offsetof(Everything, wstr)),
+  member("u32", tsi::ROS_TYPE_UINT32, offsetof(Everything, u32)),
+  array<std::string, 2>(
+    member("string_array", tsi::ROS_TYPE_STRING, offsetof(Everything, string_array))),
+  sequence<int16_t>(member("shorts", tsi::ROS_TYPE_INT16, offsetof(Everything, shorts))),
+  member("f64", tsi::ROS_TYPE_DOUBLE, offsetof(Everything, f64)),
+  member("flag", tsi::ROS_TYPE_BOOLEAN, offsetof(Everything, flag)),
+  member("c", tsi::ROS_TYPE_CHAR, offsetof(Everything, c)),
+  member("f32", tsi::ROS_TYPE_FLOAT, offsetof(Everything, f32)),
+};
+const tsi::MessageMembers Everything_members =
+  message_members<Everything>("Everything", Everything_m);
+
+tsi::ServiceMembers service_members(
+  const char * name, const tsi::MessageMembers & request, const tsi::MessageMembers & response)
+{
+  tsi::ServiceMembers m{};
+  m.service_namespace_ = "test_types::srv";
+  m.service_name_ = name;
+  m.request_members_ = &request;
+  m.response_members_ = &response;
+  return m;
+}
+
+rosidl_service_type_support_t type_support(const tsi::ServiceMembers & members)
+{
+  rosidl_service_type_support_t ts{};
+  ts.typesupport_identifier = tsi::typesupport_identifier;
+  ts.data = &members;
+  ts.func = get_service_typesupport_handle_function;
+  return ts;
+}
+
+const tsi::ServiceMembers Exchange_members =
+  service_members("Exchange", Nested_members, Flat_members);
+
+/* values that survive a round trip exactly */
+double random_double(std::mt19937_64 & rng)
+{
+  return static_cast<double>(rng() % 100000) / 8.0 - 5000.0;
+}
+
+float random_float(std::mt19937_64 & rng)
+{
+  return static_cast<float>(rng() % 1000) / 4.0f;
+}
+
+std::string random_string(std::mt19937_64 & rng, size_t max_length)
+{
+  std::string s(rng() % (max_length + 1), 'a');
+  for (auto & c : s) {
+    c = static_cast<char>('a' + rng() % 26);
+  }
+  return s;
+}
+
+Nested random_nested(std::mt19937_64 & rng)
+{
+  Nested n;
+  /* also the padding, for types that are compared as bytes */
+  memset(&n, 0, sizeof(n));
+  n.a = static_cast<uint8_t>(rng());
+  n.b = random_double(rng);
+  return n;
+}
+
+Vec3f random_vec3f(std::mt19937_64 & rng)
+{
+  return Vec3f{random_float(rng), random_float(rng), random_float(rng)};
+}
+
+}  // namespace
+
+const rosidl_message_type_support_t Nested_ts = type_support(Nested_members);
+const rosidl_message_type_support_t Vec3f_ts = type_support(Vec3f_members);
+const rosidl_message_type_support_t Flat_ts = type_support(Flat_members);
+const rosidl_message_type_support_t FlatPadded_ts = type_support(FlatPadded_members);
+const rosidl_message_type_support_t Everything_ts = type_support(Everything_members);
+const rosidl_service_type_support_t Exchange_ts = type_support(Exchange_members);
+
+bool operator==(const Nested & x, const Nested & y)
+{
+  return x.a == y.a && x.b == y.b;
+}
+
+bool operator==(const Vec3f & x, const Vec3f & y)
+{
+  return x.x == y.x && x.y == y.y && x.z == y.z;
+}
+
+bool operator==(const Everything & x, const Everything & y)
+{
+  return x.u8 == y.u8 && x.nested == y.nested && x.points == y.points &&
+         x.doubles == y.doubles && x.str == y.str && x.vectors == y.vectors &&
+         x.nesteds == y.nesteds && x.strings == y.strings && x.i16 == y.i16 &&
+         x.bools == y.bools && x.nested_array == y.nested_array && x.bytes == y.bytes &&
+         x.i64 == y.i64 && x.wstr == y.wstr && x.u32 == y.u32 &&
+         x.string_array == y.string_array && x.shorts == y.shorts && x.f64 == y.f64 &&
+         x.flag == y.flag && x.c == y.c && x.f32 == y.f32;
+}
+
+void fill(Everything & msg, std::mt19937_64 & rng, size_t max_length)
+{
+  auto length = [&rng, max_length]() {return rng() % (max_length + 1);};
+  msg.u8 = static_cast<uint8_t>(rng());
+  msg.nested = random_nested(rng);
+  for (auto & p : msg.points) {
+    p = random_vec3f(rng);
+  }
+  msg.doubles.resize(length());
+  for (auto & d : msg.doubles) {
+    d = random_double(rng);
+  }
+  msg.str = random_string(rng, max_length);
+  msg.vectors.resize(length());
+  for (auto & v : msg.vectors) {
+    v = random_vec3f(rng);
+  }
+  msg.nesteds.resize(length());
+  for (auto & n : msg.nesteds) {
+    n = random_nested(rng);
+  }
+  msg.strings.resize(length());
+  for (auto & s : msg.strings) {
+    s = random_string(rng, max_length);
+  }
+  msg.i16 = static_cast<int16_t>(rng());
+  msg.bools.resize(length());
+  for (size_t i = 0; i < msg.bools.size(); i++) {
+    msg.bools[i] = (rng() & 1) != 0;
+  }
+  for (auto & n : msg.nested_array) {
+    n = random_nested(rng);
+  }
+  msg.bytes.resize(length());
+  for (auto & b : msg.bytes) {
+    b = static_cast<uint8_t>(rng());
+  }
+  msg.i64 = static_cast<int64_t>(rng());
+  msg.wstr.resize(length());
+  for (auto & c : msg.wstr) {
+    c = static_cast<char16_t>(u'A' + rng() % 26);
+  }
+  msg.u32 = static_cast<uint32_t>(rng());
+  for (auto & s : msg.string_array) {
+    s = random_string(rng, max_length);
+  }
+  msg.shorts.resize(length());
+  for (auto & s : msg.shorts) {
+    s = static_cast<int16_t>(rng());
+  }
+  msg.f64 = random_double(rng);
+  msg.flag = (rng() & 1) != 0;
+  msg.c = static_cast<char>('a' + rng() % 26);
+  msg.f32 = random_float(rng);
+}
+
+void fill(Flat & msg, std::mt19937_64 & rng)
+{
+  memset(&msg, 0, sizeof(msg));
+  msg.a = random_double(rng);
+  msg.b = static_cast<int32_t>(rng());
+  msg.c = static_cast<int32_t>(rng());
+  for (auto & v : msg.v) {
+    v = random_vec3f(rng);
+  }
+  msg.z = rng();
+}
+
+void fill_to_bounds(Everything & msg, size_t length)
+{
+  std::mt19937_64 rng(1);
+  fill(msg, rng);
+  const std::string s(length, 'x');
+  msg.doubles.resize(length);
+  msg.str = s;
+  msg.vectors.resize(length);
+  msg.nesteds.resize(length);
+  msg.strings.assign(length, s);
+  msg.bools.resize(length);
+  msg.bytes.resize(length);
+  msg.wstr.assign(length, u'x');
+  msg.string_array = {s, s};
+  msg.shorts.resize(length);
+}
+
+}  // namespace test_types
@@ -0,0 +1,117 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MESSAGE_TYPES_HPP_
+#define MESSAGE_TYPES_HPP_
+
+/* Message types for the tests, with introspection data written by hand rather than generated,
+   so that the tests cover every kind of member without depending on message packages. */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "rosidl_runtime_c/service_type_support_struct.h"
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+#include "rosidl_typesupport_introspection_cpp/service_introspection.hpp"
+
+namespace test_types
+{
+
+namespace tsi = rosidl_typesupport_introspection_cpp;
+
+struct Nested
+{
+  uint8_t a;
+  double b;
+};
+
+struct Vec3f
+{
+  float x, y, z;
+};
+
+/* serialized as a verbatim copy of the message */
+struct Flat
+{
+  double a;
+  int32_t b;
+  int32_t c;
+  std::array<Vec3f, 2> v;
+  uint64_t z;
+};
+
+/* fixed size, but with padding in memory */
+struct FlatPadded
+{
+  uint8_t a;
+  double b;
+  int16_t c;
+};
+
+/* a bit of everything */
+struct Everything
+{
+  uint8_t u8;
+  Nested nested;
+  std::array<Vec3f, 3> points;
+  std::vector<double> doubles;
+  std::string str;
+  std::vector<Vec3f> vectors;
+  std::vector<Nested> nesteds;
+  std::vector<std::string> strings;
+  int16_t i16;
+  std::vector<bool> bools;
+  std::array<Nested, 2> nested_array;
+  std::vector<uint8_t> bytes;
+  int64_t i64;
+  std::u16string wstr;
+  uint32_t u32;
+  std::array<std::string, 2> string_array;
+  std::vector<int16_t> shorts;
+  double f64;
+  bool flag;
+  char c;
+  float f32;
+};
+
+bool operator==(const Nested & x, const Nested & y);
+bool operator==(const Vec3f & x, const Vec3f & y);
+bool operator==(const Everything & x, const Everything & y);
+
+extern const rosidl_message_type_support_t Nested_ts;
+extern const rosidl_message_type_support_t Vec3f_ts;
+extern const rosidl_message_type_support_t Flat_ts;
+extern const rosidl_message_type_support_t FlatPadded_ts;
+extern const rosidl_message_type_support_t Everything_ts;
+/* a service with a Nested request and a Flat response */
+extern const rosidl_service_type_support_t Exchange_ts;
+
+/* Fill a message with pseudo-random contents, sequences and strings get at most max_length
+   elements */
+void fill(Everything & msg, std::mt19937_64 & rng, size_t max_length = 5);
+void fill(Flat & msg, std::mt19937_64 & rng);
+
+/* Fill a message to the given bounds: every unbounded sequence gets length elements and every
+   string length characters */
+void fill_to_bounds(Everything & msg, size_t length);
+
+}  // namespace test_types
+
+#endif  // MESSAGE_TYPES_HPP_
@@ -0,0 +1,212 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Serialization.hpp"
+#include "TypeSupport2.hpp"
+#include "cdr_view.hpp"
+#include "message_types.hpp"
+#include "rmw/error_handling.h"
+
+using rmw_cyclonedds_cpp::make_cdr_writer;
+using rmw_cyclonedds_cpp::make_message_value_type;
+
+namespace
+{
+
+class CDRView : public ::testing::TestWithParam<endian>
+{
+protected:
+  void SetUp() override
+  {
+    writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts), GetParam());
+  }
+
+  /* serialize the message and make a view of it */
+  rmw_cyclonedds_cpp_cdr_view_t * view_of(const test_types::Everything & msg)
+  {
+    data.resize(writer->get_serialized_size(&msg));
+    writer->serialize(data.data(), &msg);
+    view = std::make_unique<rmw_cyclonedds_cpp_cdr_view_t>(
+      nullptr, writer->root_value_type(), data.data(), data.size());
+    return view.get();
+  }
+
+  template<typename T>
+  T get(const char * path)
+  {
+    T value {};
+    EXPECT_EQ(
+      rmw_cyclonedds_cpp_cdr_view_get_primitive(view.get(), path, &value, sizeof(value)),
+      RMW_RET_OK) << path;
+    return value;
+  }
+
+  std::string get_string(const char * path)
+  {
+    const char * s = nullptr;
+    size_t length = 0;
+    EXPECT_EQ(rmw_cyclonedds_cpp_cdr_view_get_string(view.get(), path, &s, &length), RMW_RET_OK)
+      << path;
+    return std::string(s, length);
+  }
+
+  size_t get_size(const char * path)
+  {
+    size_t size = 0;
+    EXPECT_EQ(rmw_cyclonedds_cpp_cdr_view_get_size(view.get(), path, &size), RMW_RET_OK) << path;
+    return size;
+  }
+
+  std::unique_ptr<rmw_cyclonedds_cpp::BaseCDRWriter> writer;
+  std::vector<unsigned char> data;
+  std::unique_ptr<rmw_cyclonedds_cpp_cdr_view_t> view;
+};
+
+std::string indexed(const char * name, size_t index, const char * member = "")
+{
+  return std::string(name) + "[" + std::to_string(index) + "]" + member;
+}
+
+}  // namespace
+
+TEST_P(CDRView, reads_fields_in_any_order) {
+  std::mt19937_64 rng(5);
+  for (int i = 0; i < 100; i++) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng);
+    view_of(msg);
+
+    /* later fields first, so that the positions of earlier ones are found on the way */
+    EXPECT_EQ(get<float>("f32"), msg.f32);
+    EXPECT_EQ(get<uint8_t>("u8"), msg.u8);
+    EXPECT_EQ(get<double>("nested.b"), msg.nested.b);
+    EXPECT_EQ(get<float>("points[2].y"), msg.points[2].y);
+    EXPECT_EQ(get_size("doubles"), msg.doubles.size());
+    for (size_t k = 0; k < msg.doubles.size(); k++) {
+      EXPECT_EQ(get<double>(indexed("doubles", k).c_str()), msg.doubles[k]);
+    }
+    EXPECT_EQ(get_string("str"), msg.str);
+    for (size_t k = msg.nesteds.size(); k-- > 0; ) {
+      EXPECT_EQ(get<double>(indexed("nesteds", k, ".b").c_str()), msg.nesteds[k].b);
+      EXPECT_EQ(get<uint8_t>(indexed("nesteds", k, ".a").c_str()), msg.nesteds[k].a);
+    }
+    for (size_t k = 0; k < msg.vectors.size(); k++) {
+      EXPECT_EQ(get<float>(indexed("vectors", k, ".z").c_str()), msg.vectors[k].z);
+    }
+    for (size_t k = 0; k < msg.strings.size(); k++) {
+      EXPECT_EQ(get_string(indexed("strings", k).c_str()), msg.strings[k]);
+    }
+    EXPECT_EQ(get<int16_t>("i16"), msg.i16);
+    EXPECT_EQ(get_size("bools"), msg.bools.size());
+    for (size_t k = 0; k < msg.bools.size(); k++) {
+      EXPECT_EQ(get<bool>(indexed("bools", k).c_str()), msg.bools[k]);
+    }
+    EXPECT_EQ(get<uint8_t>("nested_array[1].a"), msg.nested_array[1].a);
+    EXPECT_EQ(get<int64_t>("i64"), msg.i64);
+    EXPECT_EQ(get_size("wstr"), msg.wstr.size());
+    EXPECT_EQ(get<uint32_t>("u32"), msg.u32);
+    EXPECT_EQ(get_string("string_array[1]"), msg.string_array[1]);
+    EXPECT_EQ(get_size("points"), 3u);
+    EXPECT_EQ(get<double>("f64"), msg.f64);
+    EXPECT_EQ(get<bool>("flag"), msg.flag);
+    EXPECT_EQ(get<char>("c"), msg.c);
+  }
+}
+
+TEST_P(CDRView, returns_the_serialized_elements_of_sequences) {
+  std::mt19937_64 rng(6);
+  test_types::Everything msg;
+  test_types::fill(msg, rng);
+  msg.bytes = {1, 2, 3};
+  msg.shorts = {-1, 2, 300};
+  view_of(msg);
+
+  const void * elements = nullptr;
+  size_t size = 0;
+  ASSERT_EQ(
+    rmw_cyclonedds_cpp_cdr_view_get_data(view.get(), "bytes", &elements, &size), RMW_RET_OK);
+  ASSERT_EQ(size, 3u);
+  EXPECT_EQ(memcmp(elements, msg.bytes.data(), size), 0);
+
+  rmw_ret_t ret = rmw_cyclonedds_cpp_cdr_view_get_data(view.get(), "shorts", &elements, &size);
+  if (GetParam() == native_endian()) {
+    ASSERT_EQ(ret, RMW_RET_OK);
+    ASSERT_EQ(size, 3 * sizeof(int16_t));
+    EXPECT_EQ(memcmp(elements, msg.shorts.data(), size), 0);
+  } else {
+    /* the elements can't be used as they are */
+    EXPECT_EQ(ret, RMW_RET_UNSUPPORTED);
+  }
+}
+
+TEST_P(CDRView, rejects_invalid_paths) {
+  std::mt19937_64 rng(7);
+  test_types::Everything msg;
+  test_types::fill(msg, rng);
+  msg.doubles.resize(2);
+  view_of(msg);
+
+  double d;
+  for (const char * path : {"", "nope", "nested.c", "nested.b.c", "nested[0]", "doubles[2]",
+      "doubles[x]", "doubles[1", "points[3].x", "str.x", ".u8", "u8."})
+  {
+    EXPECT_EQ(
+      rmw_cyclonedds_cpp_cdr_view_get_primitive(view.get(), path, &d, sizeof(d)),
+      RMW_RET_INVALID_ARGUMENT) << path;
+    rmw_reset_error();
+  }
+  /* a field of another size than requested */
+  EXPECT_EQ(
+    rmw_cyclonedds_cpp_cdr_view_get_primitive(view.get(), "nested.b", &d, 4),
+    RMW_RET_INVALID_ARGUMENT);
+  rmw_reset_error();
+  /* not a string */
+  const char * s;
+  size_t length;
+  EXPECT_EQ(
+    rmw_cyclonedds_cpp_cdr_view_get_string(view.get(), "u32", &s, &length),
+    RMW_RET_INVALID_ARGUMENT);
+  rmw_reset_error();
+}
+
+TEST_P(CDRView, fails_on_truncated_data) {
+  std::mt19937_64 rng(8);
+  test_types::Everything msg;
+  test_types::fill(msg, rng);
+  view_of(msg);
+  const std::vector<unsigned char> full = data;
+
+  for (size_t cut = 4; cut < full.size(); cut += 3) {
+    rmw_cyclonedds_cpp_cdr_view_t truncated(
+      nullptr, writer->root_value_type(), full.data(), cut);
+    float f;
+    EXPECT_NE(
+      rmw_cyclonedds_cpp_cdr_view_get_primitive(&truncated, "f32", &f, sizeof(f)),
+      RMW_RET_OK) << "cut at " << cut;
+    rmw_reset_error();
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  ByteOrder, CDRView, ::testing::Values(endian::little, endian::big),
+  [](const ::testing::TestParamInfo<endian> & info) {
+    return info.param == endian::little ? "little_endian" : "big_endian";
+  });
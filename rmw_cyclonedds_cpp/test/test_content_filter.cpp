@@ -0,0 +1,295 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Serialization.hpp"
+#include "TypeSupport2.hpp"
+#include "content_filter.hpp"
+#include "message_types.hpp"
+
+using rmw_cyclonedds_cpp::make_cdr_writer;
+using rmw_cyclonedds_cpp::make_message_value_type;
+
+namespace
+{
+
+class ContentFilter : public ::testing::TestWithParam<endian>
+{
+protected:
+  void SetUp() override
+  {
+    value_type = make_message_value_type(&test_types::Everything_ts);
+    writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts), GetParam());
+  }
+
+  std::unique_ptr<rmw_cyclonedds_cpp::ContentFilter> compile(
+    const std::string & expression, const std::vector<std::string> & parameters = {})
+  {
+    return std::make_unique<rmw_cyclonedds_cpp::ContentFilter>(
+      *value_type, expression, parameters);
+  }
+
+  std::vector<unsigned char> serialize(const test_types::Everything & msg)
+  {
+    std::vector<unsigned char> data(writer->get_serialized_size(&msg));
+    writer->serialize(data.data(), &msg);
+    return data;
+  }
+
+  bool accepts(
+    const test_types::Everything & msg, const std::string & expression,
+    const std::vector<std::string> & parameters = {})
+  {
+    auto data = serialize(msg);
+    return compile(expression, parameters)->accepts(data.data(), data.size());
+  }
+
+  /* a message with known values in the fields the tests look at */
+  static test_types::Everything example()
+  {
+    std::mt19937_64 rng(1);
+    test_types::Everything msg;
+    test_types::fill(msg, rng);
+    msg.u8 = 200;
+    msg.i16 = -300;
+    msg.u32 = 3000000000u;
+    msg.f64 = 2.5;
+    msg.str = "hello";
+    msg.flag = true;
+    msg.c = 'a';
+    msg.nested = {7, -1.5};
+    msg.points[2].y = 4.0f;
+    msg.doubles = {1.0, 2.0, 3.0};
+    msg.nesteds = {{1, 1.0}, {2, 2.0}};
+    msg.strings = {"abc", "def"};
+    msg.bools = {false, true};
+    msg.nested_array[1].a = 9;
+    msg.string_array = {"x", "y"};
+    return msg;
+  }
+
+  std::unique_ptr<rmw_cyclonedds_cpp::StructValueType> value_type;
+  std::unique_ptr<rmw_cyclonedds_cpp::BaseCDRWriter> writer;
+};
+
+std::string repeat(const std::string & s, size_t n)
+{
+  std::string result;
+  for (size_t i = 0; i < n; i++) {
+    result += s;
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_P(ContentFilter, compares_fields_with_literals) {
+  auto msg = example();
+  EXPECT_TRUE(accepts(msg, "u8 = 200"));
+  EXPECT_FALSE(accepts(msg, "u8 <> 200"));
+  EXPECT_FALSE(accepts(msg, "u8 != 200"));
+  EXPECT_TRUE(accepts(msg, "u8 == 200"));
+  EXPECT_TRUE(accepts(msg, "i16 < -100"));
+  EXPECT_FALSE(accepts(msg, "i16 > -300"));
+  EXPECT_TRUE(accepts(msg, "i16 >= -300"));
+  EXPECT_TRUE(accepts(msg, "u32 > 2147483648"));
+  EXPECT_TRUE(accepts(msg, "u32 = 0xB2D05E00"));
+  EXPECT_TRUE(accepts(msg, "u32 > -1"));
+  EXPECT_TRUE(accepts(msg, "f64 > 2"));
+  EXPECT_TRUE(accepts(msg, "f64 <= 2.5"));
+  EXPECT_TRUE(accepts(msg, "f64 = 25e-1"));
+  EXPECT_TRUE(accepts(msg, "str = 'hello'"));
+  EXPECT_TRUE(accepts(msg, "str < 'help'"));
+  EXPECT_FALSE(accepts(msg, "str < 'hell'"));
+  EXPECT_TRUE(accepts(msg, "flag = TRUE"));
+  EXPECT_TRUE(accepts(msg, "c = 97"));
+  EXPECT_TRUE(accepts(msg, "f64 BETWEEN 2 AND 3"));
+  EXPECT_FALSE(accepts(msg, "f64 NOT BETWEEN 2 AND 3"));
+  EXPECT_TRUE(accepts(msg, "str LIKE 'h%o'"));
+  EXPECT_TRUE(accepts(msg, "str LIKE '_el%'"));
+  EXPECT_FALSE(accepts(msg, "str NOT LIKE '%ll%'"));
+}
+
+TEST_P(ContentFilter, tokenizes_whitespace_keywords_and_quotes) {
+  auto msg = example();
+  EXPECT_TRUE(accepts(msg, "  u8\t=\n200\r"));
+  EXPECT_TRUE(accepts(msg, "u8=200 and(i16<0)"));
+  EXPECT_TRUE(accepts(msg, "f64 between 2 and 3"));
+  EXPECT_TRUE(accepts(msg, "flag = true AND NoT flag = False"));
+  msg.str = "it's";
+  EXPECT_TRUE(accepts(msg, "str = 'it''s'"));
+  msg.str = "";
+  EXPECT_TRUE(accepts(msg, "str = ''"));
+  EXPECT_TRUE(accepts(msg, "str LIKE '%'"));
+}
+
+TEST_P(ContentFilter, matches_like_patterns) {
+  auto msg = example();
+  msg.str = "a%b";
+  EXPECT_TRUE(accepts(msg, "str LIKE 'a%'"));
+  EXPECT_TRUE(accepts(msg, "str LIKE 'a%b'"));
+  EXPECT_TRUE(accepts(msg, "str LIKE '%%_'"));
+  EXPECT_FALSE(accepts(msg, "str LIKE 'a%c'"));
+  msg.str = "%xa";
+  EXPECT_TRUE(accepts(msg, "str LIKE '%a'"));
+  EXPECT_TRUE(accepts(msg, "str LIKE '_x%'"));
+  EXPECT_FALSE(accepts(msg, "str LIKE '%x'"));
+  msg.str = "abab";
+  EXPECT_TRUE(accepts(msg, "str LIKE '%ab'"));
+  EXPECT_FALSE(accepts(msg, "str LIKE '%ba'"));
+}
+
+TEST_P(ContentFilter, binds_and_tighter_than_or) {
+  auto msg = example();
+  EXPECT_TRUE(accepts(msg, "u8 = 200 OR i16 = 5 AND u32 = 5"));
+  EXPECT_FALSE(accepts(msg, "(u8 = 200 OR i16 = 5) AND u32 = 5"));
+  EXPECT_TRUE(accepts(msg, "i16 = 5 AND u32 = 5 OR u8 = 200"));
+  EXPECT_TRUE(accepts(msg, "NOT u8 = 1 AND i16 = -300"));
+  EXPECT_FALSE(accepts(msg, "NOT (u8 = 200 OR i16 = 5)"));
+  EXPECT_TRUE(accepts(msg, "NOT NOT u8 = 200"));
+}
+
+TEST_P(ContentFilter, substitutes_parameters) {
+  auto msg = example();
+  EXPECT_TRUE(accepts(msg, "u8 = %0 AND str LIKE %1", {"200", "'he%'"}));
+  EXPECT_TRUE(accepts(msg, "%1 > i16 AND f64 < %0", {"2.75", "-299"}));
+  EXPECT_TRUE(accepts(msg, "flag = %0", {"TRUE"}));
+
+  /* updating the parameters is compiling the filter again */
+  std::vector<std::string> parameters = {"200"};
+  auto filter = compile("u8 = %0", parameters);
+  parameters[0] = "201";
+  auto updated = compile("u8 = %0", parameters);
+  auto data = serialize(msg);
+  EXPECT_TRUE(filter->accepts(data.data(), data.size()));
+  EXPECT_FALSE(updated->accepts(data.data(), data.size()));
+  EXPECT_EQ(filter->parameters(), std::vector<std::string>{"200"});
+  EXPECT_EQ(updated->parameters(), std::vector<std::string>{"201"});
+  EXPECT_EQ(updated->expression(), "u8 = %0");
+}
+
+TEST_P(ContentFilter, reads_nested_members_and_elements) {
+  auto msg = example();
+  EXPECT_TRUE(accepts(msg, "nested.a = 7 AND nested.b = -1.5"));
+  EXPECT_TRUE(accepts(msg, "points[2].y = 4"));
+  EXPECT_TRUE(accepts(msg, "doubles[0] = 1 AND doubles[2] = 3"));
+  EXPECT_TRUE(accepts(msg, "nesteds[1].a = 2 AND nesteds[1].b = 2"));
+  EXPECT_TRUE(accepts(msg, "strings[1] = 'def' AND strings[0] < strings[1]"));
+  EXPECT_TRUE(accepts(msg, "bools[0] = FALSE AND bools[1] = TRUE"));
+  EXPECT_TRUE(accepts(msg, "nested_array[1].a = 9"));
+  EXPECT_TRUE(accepts(msg, "string_array[1] = 'y'"));
+
+  /* an element beyond the end of a sequence is neither equal nor unequal to anything */
+  EXPECT_FALSE(accepts(msg, "doubles[3] = 1"));
+  EXPECT_FALSE(accepts(msg, "NOT doubles[3] = 1"));
+  EXPECT_TRUE(accepts(msg, "doubles[3] = 1 OR u8 = 200"));
+  EXPECT_FALSE(accepts(msg, "doubles[3] = 1 AND u8 = 200"));
+}
+
+TEST_P(ContentFilter, agrees_with_the_deserialized_message) {
+  struct Case
+  {
+    const char * expression;
+    std::function<bool(const test_types::Everything &)> expected;
+  };
+  const std::vector<Case> cases = {
+    {"u8 < 128", [](const test_types::Everything & m) {return m.u8 < 128;}},
+    {"i64 >= 0 OR i16 < 0", [](const test_types::Everything & m) {return m.i64 >= 0 || m.i16 < 0;}},
+    {"f32 BETWEEN 10 AND 100", [](const test_types::Everything & m) {
+        return m.f32 >= 10 && m.f32 <= 100;
+      }},
+    {"str > 'm'", [](const test_types::Everything & m) {return m.str > "m";}},
+    {"vectors[1].z < 100", [](const test_types::Everything & m) {
+        return m.vectors.size() > 1 && m.vectors[1].z < 100;
+      }},
+    {"strings[0] <= string_array[0]", [](const test_types::Everything & m) {
+        return !m.strings.empty() && m.strings[0] <= m.string_array[0];
+      }},
+    {"bytes[1] >= 128 AND shorts[0] < 0", [](const test_types::Everything & m) {
+        return m.bytes.size() > 1 && m.bytes[1] >= 128 && !m.shorts.empty() && m.shorts[0] < 0;
+      }},
+    {"f64 > 0 AND u32 < 2147483648", [](const test_types::Everything & m) {
+        return m.f64 > 0 && m.u32 < 2147483648u;
+      }},
+  };
+  std::vector<std::unique_ptr<rmw_cyclonedds_cpp::ContentFilter>> filters;
+  for (const auto & c : cases) {
+    filters.push_back(compile(c.expression));
+  }
+
+  std::mt19937_64 rng(9);
+  for (int i = 0; i < 500; i++) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng);
+    auto data = serialize(msg);
+    for (size_t k = 0; k < cases.size(); k++) {
+      ASSERT_EQ(filters[k]->accepts(data.data(), data.size()), cases[k].expected(msg))
+        << cases[k].expression << ", iteration " << i;
+    }
+  }
+}
+
+TEST_P(ContentFilter, rejects_truncated_data_and_accepts_unknown_encodings) {
+  auto msg = example();
+  auto filter = compile("f32 = f32");
+  auto data = serialize(msg);
+  ASSERT_TRUE(filter->accepts(data.data(), data.size()));
+  /* f32 is the last field, so it is missing from any shorter data */
+  for (size_t cut = 4; cut < data.size(); cut++) {
+    EXPECT_FALSE(filter->accepts(data.data(), cut)) << "cut at " << cut;
+  }
+  /* XCDR2, which only deserializing can make sense of */
+  data[1] = 7;
+  EXPECT_TRUE(filter->accepts(data.data(), data.size()));
+}
+
+TEST_P(ContentFilter, rejects_unsupported_expressions) {
+  for (const char * expression : {
+      "", "u8", "u8 <", "u8 = 1 u8", "u8 = 1 AND", "(u8 = 1", "u8 = 1)", "u8 ! 1", "u8 @ 1",
+      "nope = 1", "nested.c = 1", "nested = 1", "u8.a = 1", "points[3].x = 1", "u8[0] = 1",
+      "doubles[-1] = 1", "doubles[x] = 1", "str = 1", "u8 = 'x'", "u8 LIKE 'a'",
+      "str = 'x", "u8 BETWEEN 1 OR 2", "u8 = 1e999", "AND = 1", "u8 = %2", "u8 = %100",
+      "u8 = %1", "wstr = 'a'", "doubles = 1"})
+  {
+    EXPECT_THROW(compile(expression, {"1", "u8"}), std::invalid_argument) << expression;
+  }
+}
+
+TEST_P(ContentFilter, limits_nesting) {
+  auto msg = example();
+  EXPECT_TRUE(accepts(msg, repeat("(", 50) + "u8 = 200" + repeat(")", 50)));
+  EXPECT_TRUE(accepts(msg, repeat("NOT ", 50) + "u8 = 200"));
+  EXPECT_TRUE(accepts(msg, repeat("u8 = 1 OR ", 50) + "u8 = 200"));
+  EXPECT_TRUE(accepts(msg, repeat("u8 = 200 AND ", 50) + "u8 = 200"));
+
+  /* deep enough to run out of stack if it weren't limited */
+  const size_t deep = 100000;
+  EXPECT_THROW(compile(repeat("(", deep) + "u8 = 200" + repeat(")", deep)), std::invalid_argument);
+  EXPECT_THROW(compile(repeat("NOT ", deep) + "u8 = 200"), std::invalid_argument);
+  EXPECT_THROW(compile(repeat("u8 = 1 OR ", deep) + "u8 = 200"), std::invalid_argument);
+  EXPECT_THROW(compile(repeat("u8 = 1 AND ", deep) + "u8 = 200"), std::invalid_argument);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+  ByteOrder, ContentFilter, ::testing::Values(endian::little, endian::big),
+  [](const ::testing::TestParamInfo<endian> & info) {
+    return info.param == endian::little ? "little_endian" : "big_endian";
+  });
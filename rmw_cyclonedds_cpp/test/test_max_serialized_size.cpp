@@ -0,0 +1,80 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "message_types.hpp"
+#include "rmw_cyclonedds_cpp/sequence_bounds.h"
+#include "type_registry.hpp"
+
+using rmw_cyclonedds_cpp::get_registered_message_type;
+
+TEST(MaxSerializedSize, is_the_fixed_size_for_fixed_size_types) {
+  for (auto ts : {&test_types::Flat_ts, &test_types::FlatPadded_ts, &test_types::Nested_ts}) {
+    auto type = get_registered_message_type(ts);
+    size_t size = 0;
+    ASSERT_TRUE(type->get_max_serialized_size(nullptr, size));
+    EXPECT_EQ(size, type->writer->get_fixed_serialized_size());
+    EXPECT_GT(size, 0u);
+  }
+}
+
+TEST(MaxSerializedSize, needs_bounds_for_unbounded_types) {
+  auto type = get_registered_message_type(&test_types::Everything_ts);
+  size_t size = 0;
+  EXPECT_FALSE(type->get_max_serialized_size(nullptr, size));
+}
+
+TEST(MaxSerializedSize, is_reached_by_a_message_filled_to_the_bounds) {
+  auto type = get_registered_message_type(&test_types::Everything_ts);
+  for (size_t length : {0, 1, 2, 3, 7, 9, 100}) {
+    rmw_cyclonedds_cpp_sequence_bounds_t bounds {length, length};
+    size_t size = 0;
+    ASSERT_TRUE(type->get_max_serialized_size(&bounds, size));
+
+    test_types::Everything msg;
+    test_types::fill_to_bounds(msg, length);
+    EXPECT_EQ(type->writer->get_serialized_size(&msg), size) << "length " << length;
+  }
+}
+
+TEST(MaxSerializedSize, is_never_exceeded_within_the_bounds) {
+  auto type = get_registered_message_type(&test_types::Everything_ts);
+  const size_t max_length = 6;
+  rmw_cyclonedds_cpp_sequence_bounds_t bounds {max_length, max_length};
+  size_t size = 0;
+  ASSERT_TRUE(type->get_max_serialized_size(&bounds, size));
+
+  std::mt19937_64 rng(5);
+  for (int i = 0; i < 1000; i++) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng, max_length);
+    ASSERT_LE(type->writer->get_serialized_size(&msg), size) << "iteration " << i;
+  }
+}
+
+TEST(MaxSerializedSize, uses_separate_bounds_for_sequences_and_strings) {
+  auto type = get_registered_message_type(&test_types::Everything_ts);
+  rmw_cyclonedds_cpp_sequence_bounds_t longer_sequences {10, 2};
+  rmw_cyclonedds_cpp_sequence_bounds_t longer_strings {2, 10};
+  rmw_cyclonedds_cpp_sequence_bounds_t both {10, 10};
+  size_t s1 = 0, s2 = 0, s3 = 0;
+  ASSERT_TRUE(type->get_max_serialized_size(&longer_sequences, s1));
+  ASSERT_TRUE(type->get_max_serialized_size(&longer_strings, s2));
+  ASSERT_TRUE(type->get_max_serialized_size(&both, s3));
+  EXPECT_NE(s1, s2);
+  EXPECT_LT(s1, s3);
+  EXPECT_LT(s2, s3);
+}
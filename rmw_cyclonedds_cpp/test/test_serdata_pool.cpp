@@ -0,0 +1,115 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "message_types.hpp"
+#include "serdata.hpp"
+#include "serdata_pool.hpp"
+#include "type_registry.hpp"
+
+using rmw_cyclonedds_cpp::allocate_serdata;
+using rmw_cyclonedds_cpp::release_serdata;
+
+class SerdataPool : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    type = create_sertype(
+      rmw_cyclonedds_cpp::get_registered_message_type(&test_types::Everything_ts));
+  }
+
+  void TearDown() override
+  {
+    ddsi_sertype_unref(type);
+  }
+
+  struct sertype_rmw * type {nullptr};
+};
+
+TEST_F(SerdataPool, recycles_serdata_with_their_buffers) {
+  serdata_rmw * d = allocate_serdata(type, SDK_DATA, 100);
+  EXPECT_EQ(d->size(), 0u);
+  EXPECT_GE(d->capacity(), 100u);
+  d->resize(100);
+  release_serdata(d);
+
+  serdata_rmw * d1 = allocate_serdata(type, SDK_DATA, 100);
+  EXPECT_EQ(d1, d);
+  EXPECT_EQ(d1->size(), 0u);
+  EXPECT_GE(d1->capacity(), 100u);
+  release_serdata(d1);
+}
+
+TEST_F(SerdataPool, serdata_start_out_serialized) {
+  serdata_rmw * d = allocate_serdata(type, SDK_DATA, 0);
+  /* even with an empty payload there is no serializing on demand */
+  EXPECT_FALSE(d->begin_serialize());
+  release_serdata(d);
+}
+
+TEST_F(SerdataPool, recycled_serdata_do_not_inherit_the_serialize_state) {
+  serdata_rmw * d = allocate_serdata(type, SDK_DATA, 0);
+  d->defer_serialize();
+  release_serdata(d);
+
+  serdata_rmw * d1 = allocate_serdata(type, SDK_DATA, 0);
+  ASSERT_EQ(d1, d);
+  EXPECT_FALSE(d1->begin_serialize());
+  release_serdata(d1);
+}
+
+TEST_F(SerdataPool, deferred_serialization_happens_once) {
+  serdata_rmw * d = allocate_serdata(type, SDK_DATA, 0);
+  d->defer_serialize();
+  ASSERT_TRUE(d->begin_serialize());
+  d->end_serialize();
+  EXPECT_FALSE(d->begin_serialize());
+  release_serdata(d);
+}
+
+TEST_F(SerdataPool, received_samples_of_memcpy_serialized_types_are_used_in_place) {
+  struct sertype_rmw * flat_type = create_sertype(
+    rmw_cyclonedds_cpp::get_registered_message_type(&test_types::Flat_ts));
+  std::mt19937_64 rng(7);
+  /* buffers of new and of recycled serdata alike */
+  for (int i = 0; i < 3; i++) {
+    test_types::Flat msg;
+    test_types::fill(msg, rng);
+    struct ddsi_serdata * sent = ddsi_serdata_from_sample(flat_type, SDK_DATA, &msg);
+    ASSERT_NE(sent, nullptr);
+    std::vector<unsigned char> bytes(ddsi_serdata_size(sent));
+    ddsi_serdata_to_ser(sent, 0, bytes.size(), bytes.data());
+    ddsi_serdata_unref(sent);
+
+    ddsrt_iovec_t iov;
+    iov.iov_base = bytes.data();
+    iov.iov_len = static_cast<ddsrt_iov_len_t>(bytes.size());
+    struct ddsi_serdata * received =
+      ddsi_serdata_from_ser_iov(flat_type, SDK_DATA, 1, &iov, bytes.size());
+    ASSERT_NE(received, nullptr);
+    auto sample = static_cast<const test_types::Flat *>(
+      serdata_rmw_sample_in_place(static_cast<serdata_rmw *>(received)));
+    ASSERT_NE(sample, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(sample) % alignof(test_types::Flat), 0u);
+    EXPECT_EQ(std::memcmp(sample, &msg, sizeof(msg)), 0);
+    ddsi_serdata_unref(received);
+  }
+  ddsi_sertype_unref(flat_type);
+}
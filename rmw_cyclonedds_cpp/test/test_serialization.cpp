@@ -0,0 +1,239 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Serialization.hpp"
+#include "TypeSupport2.hpp"
+#include "message_types.hpp"
+#include "serdata.hpp"
+#include "serdes.hpp"
+#include "type_registry.hpp"
+
+using rmw_cyclonedds_cpp::make_cdr_writer;
+using rmw_cyclonedds_cpp::make_message_value_type;
+
+namespace
+{
+
+std::vector<unsigned char> serialize(
+  const rmw_cyclonedds_cpp::BaseCDRWriter & writer, const void * msg)
+{
+  std::vector<unsigned char> data(writer.get_serialized_size(msg));
+  writer.serialize(data.data(), msg);
+  return data;
+}
+
+std::vector<unsigned char> serialize(
+  const rmw_cyclonedds_cpp::BaseCDRWriter & writer, const cdds_request_wrapper_t & request)
+{
+  std::vector<unsigned char> data(writer.get_serialized_size(request));
+  writer.serialize(data.data(), request);
+  return data;
+}
+
+template<typename T>
+std::vector<unsigned char> native_bytes(const T & x)
+{
+  std::vector<unsigned char> bytes(sizeof(x));
+  memcpy(bytes.data(), &x, sizeof(x));
+  return bytes;
+}
+
+std::vector<unsigned char> encapsulation_header()
+{
+  return {0, native_endian() == endian::little ? 1 : 0, 0, 0};
+}
+
+void append(std::vector<unsigned char> & data, const std::vector<unsigned char> & bytes)
+{
+  data.insert(data.end(), bytes.begin(), bytes.end());
+}
+
+}  // namespace
+
+TEST(Serialization, aligns_members_relative_to_the_payload) {
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::FlatPadded_ts));
+  test_types::FlatPadded msg{0x12, 2.5, -3};
+
+  std::vector<unsigned char> expected = encapsulation_header();
+  expected.push_back(0x12);
+  expected.resize(4 + 8, 0);
+  append(expected, native_bytes(msg.b));
+  append(expected, native_bytes(msg.c));
+
+  EXPECT_EQ(serialize(*writer, &msg), expected);
+  EXPECT_EQ(writer->get_fixed_serialized_size(), expected.size());
+  /* the padding in memory differs from the padding in CDR */
+  EXPECT_FALSE(writer->is_memcpy_serialized());
+}
+
+TEST(Serialization, copies_a_message_without_padding_verbatim) {
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Flat_ts));
+  ASSERT_TRUE(writer->is_memcpy_serialized());
+
+  std::mt19937_64 rng(1);
+  test_types::Flat msg;
+  test_types::fill(msg, rng);
+  std::vector<unsigned char> expected = encapsulation_header();
+  append(expected, native_bytes(msg));
+  EXPECT_EQ(serialize(*writer, &msg), expected);
+}
+
+TEST(Serialization, round_trips_every_kind_of_member) {
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts));
+  auto type = rmw_cyclonedds_cpp::get_registered_message_type(&test_types::Everything_ts);
+  EXPECT_EQ(writer->get_fixed_serialized_size(), 0u);
+
+  std::mt19937_64 rng(42);
+  for (int i = 0; i < 200; i++) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng);
+    auto data = serialize(*writer, &msg);
+    ASSERT_EQ(data.size(), writer->get_serialized_size(&msg));
+
+    test_types::Everything result;
+    cycdeser deser(data.data(), data.size());
+    ASSERT_TRUE(type->deserialize(deser, &result));
+    ASSERT_TRUE(result == msg) << "iteration " << i;
+  }
+}
+
+TEST(Serialization, single_pass_matches_two_pass) {
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts));
+
+  std::mt19937_64 rng(7);
+  for (size_t hint : {0, 1, 17, 4096}) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng, 40);
+    serdata_rmw serdata;
+    serdata.resize(hint);
+    writer->serialize(serdata, &msg);
+
+    auto expected = serialize(*writer, &msg);
+    ASSERT_EQ(serdata.size(), expected.size()) << "hint " << hint;
+    EXPECT_EQ(memcmp(serdata.data(), expected.data(), expected.size()), 0) << "hint " << hint;
+  }
+}
+
+TEST(Serialization, writes_the_request_header_before_the_message) {
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts));
+
+  std::mt19937_64 rng(3);
+  test_types::Everything msg;
+  test_types::fill(msg, rng);
+  cdds_request_wrapper_t request{{0x1122334455667788ull, 99}, &msg};
+  auto with_header = serialize(*writer, request);
+  auto without_header = serialize(*writer, &msg);
+
+  std::vector<unsigned char> expected = encapsulation_header();
+  append(expected, native_bytes(request.header.guid));
+  append(expected, native_bytes(request.header.seq));
+  /* the message is aligned to 8 bytes in both cases, so the rest is the same */
+  expected.insert(expected.end(), without_header.begin() + 4, without_header.end());
+  EXPECT_EQ(with_header, expected);
+}
+
+TEST(Serialization, references_only_large_blocks) {
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts));
+  ASSERT_TRUE(writer->may_reference_data());
+
+  const size_t min_size = rmw_cyclonedds_cpp::min_referenced_size;
+  std::mt19937_64 rng(11);
+  for (size_t n_bytes : {size_t{0}, size_t{100}, min_size - 1, min_size, size_t{100000}}) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng);
+    msg.bytes.assign(n_bytes, 0x5a);
+    serdata_rmw serdata;
+    std::vector<serdata_rmw_segment> segments;
+    writer->serialize(serdata, segments, &msg);
+
+    auto expected = serialize(*writer, &msg);
+    std::vector<unsigned char> gathered;
+    const unsigned char * own = static_cast<const unsigned char *>(serdata.data());
+    if (segments.empty()) {
+      gathered.assign(own, own + serdata.size());
+    } else {
+      for (const auto & segment : segments) {
+        auto src = segment.data ? static_cast<const unsigned char *>(segment.data) : own;
+        gathered.insert(gathered.end(), src, src + segment.size);
+        if (segment.data == nullptr) {
+          own += segment.size;
+        } else {
+          EXPECT_GE(segment.size, min_size);
+          EXPECT_EQ(segment.data, msg.bytes.data());
+        }
+      }
+    }
+    EXPECT_EQ(segments.empty(), n_bytes < min_size);
+    EXPECT_EQ(gathered, expected) << n_bytes << " bytes";
+  }
+}
+
+TEST(Serialization, swaps_bytes_on_request) {
+  const endian foreign = (native_endian() == endian::little) ? endian::big : endian::little;
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::FlatPadded_ts), foreign);
+  test_types::FlatPadded msg{0x12, 2.5, -3};
+
+  auto reversed = [](std::vector<unsigned char> bytes) {
+      std::reverse(bytes.begin(), bytes.end());
+      return bytes;
+    };
+  std::vector<unsigned char> expected = {0, foreign == endian::little ? 1 : 0, 0, 0};
+  expected.push_back(0x12);
+  expected.resize(4 + 8, 0);
+  append(expected, reversed(native_bytes(msg.b)));
+  append(expected, reversed(native_bytes(msg.c)));
+  EXPECT_EQ(serialize(*writer, &msg), expected);
+}
+
+TEST(Serialization, round_trips_in_the_foreign_byte_order) {
+  const endian foreign = (native_endian() == endian::little) ? endian::big : endian::little;
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Everything_ts), foreign);
+  auto type = rmw_cyclonedds_cpp::get_registered_message_type(&test_types::Everything_ts);
+
+  std::mt19937_64 rng(43);
+  for (int i = 0; i < 200; i++) {
+    test_types::Everything msg;
+    test_types::fill(msg, rng);
+    auto data = serialize(*writer, &msg);
+    ASSERT_EQ(data[1], foreign == endian::little ? 1 : 0);
+
+    test_types::Everything result;
+    cycdeser deser(data.data(), data.size());
+    ASSERT_TRUE(type->deserialize(deser, &result));
+    ASSERT_TRUE(result == msg) << "iteration " << i;
+  }
+}
+
+TEST(Serialization, swaps_the_request_header_on_request) {
+  const endian foreign = (native_endian() == endian::little) ? endian::big : endian::little;
+  auto writer = make_cdr_writer(make_message_value_type(&test_types::Nested_ts), foreign);
+  test_types::Nested msg{1, 2.0};
+  cdds_request_wrapper_t request{{0x1122334455667788ull, 99}, &msg};
+  auto data = serialize(*writer, request);
+
+  /* the guid is a number like the sequence number, not an array of bytes */
+  cdds_request_header_t header;
+  cycdeser deser(data.data(), data.size());
+  deser >> header.guid;
+  deser >> header.seq;
+  EXPECT_EQ(header.guid, request.header.guid);
+  EXPECT_EQ(header.seq, request.header.seq);
+}
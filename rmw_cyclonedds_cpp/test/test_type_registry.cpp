@@ -0,0 +1,111 @@
+// Copyright 2026 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "message_types.hpp"
+#include "serdata.hpp"
+#include "type_registry.hpp"
+
+using rmw_cyclonedds_cpp::RegisteredType;
+using rmw_cyclonedds_cpp::TypeRole;
+using rmw_cyclonedds_cpp::get_registered_message_type;
+using rmw_cyclonedds_cpp::get_registered_service_type;
+
+TEST(TypeRegistry, shares_the_entry_of_a_type) {
+  auto entry = get_registered_message_type(&test_types::Everything_ts);
+  EXPECT_EQ(get_registered_message_type(&test_types::Everything_ts), entry);
+  EXPECT_NE(get_registered_message_type(&test_types::Flat_ts), entry);
+}
+
+TEST(TypeRegistry, forgets_types_no_one_uses) {
+  auto entry = get_registered_message_type(&test_types::Nested_ts);
+  std::weak_ptr<const RegisteredType> weak = entry;
+  entry.reset();
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(TypeRegistry, keeps_the_entry_of_a_sertype) {
+  auto entry = get_registered_message_type(&test_types::Everything_ts);
+  const RegisteredType * registered = entry.get();
+  struct sertype_rmw * type = create_sertype(std::move(entry));
+  /* the sertype is the only one using the type now */
+  EXPECT_EQ(get_registered_message_type(&test_types::Everything_ts).get(), registered);
+  ddsi_sertype_unref(type);
+}
+
+TEST(TypeRegistry, derives_the_properties_of_a_type) {
+  auto flat = get_registered_message_type(&test_types::Flat_ts);
+  EXPECT_EQ(flat->role, TypeRole::Message);
+  EXPECT_EQ(flat->type_name, "test_types::msg::dds_::Flat_");
+  EXPECT_TRUE(flat->is_fixed_type);
+  EXPECT_EQ(flat->sample_size, sizeof(test_types::Flat));
+  EXPECT_EQ(flat->fixed_serialized_size, 4 + sizeof(test_types::Flat));
+  EXPECT_TRUE(flat->is_memcpy_serialized);
+  EXPECT_EQ(flat->memcpy_alignment, alignof(test_types::Flat));
+  /* there is nothing worth referencing in a copy of the sample */
+  EXPECT_FALSE(flat->serialize_by_reference);
+
+  auto padded = get_registered_message_type(&test_types::FlatPadded_ts);
+  EXPECT_TRUE(padded->is_fixed_type);
+  EXPECT_EQ(padded->fixed_serialized_size, padded->writer->get_fixed_serialized_size());
+  EXPECT_FALSE(padded->is_memcpy_serialized);
+  EXPECT_EQ(padded->memcpy_alignment, 0u);
+
+  auto everything = get_registered_message_type(&test_types::Everything_ts);
+  EXPECT_EQ(everything->type_name, "test_types::msg::dds_::Everything_");
+  EXPECT_FALSE(everything->is_fixed_type);
+  EXPECT_EQ(everything->sample_size, sizeof(test_types::Everything));
+  EXPECT_EQ(everything->fixed_serialized_size, 0u);
+  EXPECT_FALSE(everything->is_memcpy_serialized);
+  EXPECT_TRUE(everything->serialize_by_reference);
+}
+
+TEST(TypeRegistry, registers_requests_and_responses_separately) {
+  auto request = get_registered_service_type(&test_types::Exchange_ts, TypeRole::Request);
+  auto response = get_registered_service_type(&test_types::Exchange_ts, TypeRole::Response);
+  EXPECT_NE(request, response);
+  EXPECT_EQ(get_registered_service_type(&test_types::Exchange_ts, TypeRole::Request), request);
+
+  EXPECT_EQ(request->role, TypeRole::Request);
+  EXPECT_EQ(request->type_name, "test_types::srv::dds_::Exchange_Request_");
+  EXPECT_EQ(response->role, TypeRole::Response);
+  EXPECT_EQ(response->type_name, "test_types::srv::dds_::Exchange_Response_");
+  /* samples of services are never used in place and never published by reference */
+  EXPECT_EQ(request->sample_size, 0u);
+  EXPECT_FALSE(response->serialize_by_reference);
+
+  EXPECT_THROW(
+    get_registered_service_type(&test_types::Exchange_ts, TypeRole::Message),
+    std::invalid_argument);
+}
+
+TEST(TypeRegistry, makes_one_entry_for_concurrent_users) {
+  std::vector<std::shared_ptr<const RegisteredType>> entries(8);
+  std::vector<std::thread> threads;
+  for (auto & entry : entries) {
+    threads.emplace_back(
+      [&entry]() {entry = get_registered_message_type(&test_types::FlatPadded_ts);});
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (const auto & entry : entries) {
+    EXPECT_EQ(entry, entries[0]);
+  }
+}